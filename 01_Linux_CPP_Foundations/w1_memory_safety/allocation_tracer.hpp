@@ -0,0 +1,340 @@
+/**
+ * @file allocation_tracer.hpp
+ * @brief AllocationTracer - SafeTensorBuffer 生命周期事件的低开销记录器
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef ALLOCATION_TRACER_HPP
+#define ALLOCATION_TRACER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 编译期开关（在包含本头文件之前定义，或通过编译选项 -D 传入）
+ *
+ * | 级别 | 行为                                                   |
+ * |------|--------------------------------------------------------|
+ * | 0    | 完全关闭：不记录、不输出，调用点被 if constexpr 消除   |
+ * | 1    | 记录事件到线程本地缓冲区（默认，生产环境）             |
+ * | 2    | 记录 + 逐条输出到 std::cout（教学/调试，旧行为）       |
+ */
+#ifndef SAFE_TENSOR_TRACE
+#define SAFE_TENSOR_TRACE 1
+#endif
+
+constexpr int kSafeTensorTraceLevel = SAFE_TENSOR_TRACE;
+
+/// 事件类型
+enum class TraceEvent : uint8_t { kAllocate, kFree, kMove };
+
+inline const char *trace_event_name(TraceEvent event) {
+  switch (event) {
+  case TraceEvent::kAllocate:
+    return "allocate";
+  case TraceEvent::kFree:
+    return "free";
+  case TraceEvent::kMove:
+    return "move";
+  }
+  return "?";
+}
+
+/// 一条事件记录（32 字节）
+struct TraceRecord {
+  uint64_t timestamp_ns = 0; ///< steady_clock
+  const void *address = nullptr;
+  uint64_t size = 0;
+  uint32_t thread = 0; ///< 线程槽位编号
+  TraceEvent event = TraceEvent::kAllocate;
+};
+
+/**
+ * @class AllocationTracer
+ * @brief 把分配/释放/移动事件记录到线程本地缓冲区，按需汇总
+ *
+ * 与 std::cout + std::endl 相比：
+ * - 不格式化、不 flush、不在全局流上串行化；每个事件只是一次时间戳 + 写数组
+ * - 每个线程一个槽位（最近 kRingCapacity 条事件 + 直方图），槽位的互斥锁只在
+ *   汇总时才会发生竞争
+ * - 全局只有 live 个数/字节与 peak 三个原子量
+ */
+class AllocationTracer {
+public:
+  static constexpr size_t kRingCapacity = 256;
+  /// 直方图按 2 的幂分桶：桶 i 覆盖 [2^i, 2^(i+1))
+  static constexpr size_t kNumBuckets = 48;
+
+  /// 汇总快照
+  struct Summary {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t moves = 0;
+    uint64_t live_count = 0; ///< 存活缓冲区个数（状态，不随 reset() 清零）
+    uint64_t live_bytes = 0;
+    uint64_t peak_bytes = 0;
+    uint64_t lifetime_total_ns = 0;
+    std::array<uint64_t, kNumBuckets> size_histogram{};     ///< 分配大小
+    std::array<uint64_t, kNumBuckets> lifetime_histogram{}; ///< 存活时间 ns
+
+    /// 与 live_bytes 描述同一组缓冲区；reset() 后 allocations - frees 会下溢
+    uint64_t live_buffers() const { return live_count; }
+
+    double mean_lifetime_ns() const {
+      return frees == 0 ? 0.0
+                        : static_cast<double>(lifetime_total_ns) /
+                              static_cast<double>(frees);
+    }
+
+    /// 存活时间分位数（返回所在桶的上界，误差在 2 倍以内）
+    uint64_t lifetime_percentile_ns(double p) const {
+      const auto target = static_cast<uint64_t>(p * static_cast<double>(frees));
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += lifetime_histogram[i];
+        if (seen > target) {
+          return uint64_t{1} << (i + 1);
+        }
+      }
+      return 0;
+    }
+  };
+
+  /**
+   * @brief 进程内唯一实例
+   *
+   * 故意不析构：静态对象（如 TensorBufferPool）和线程本地缓存在退出阶段
+   * 仍会释放缓冲区，记录器必须比它们活得更久。
+   */
+  static AllocationTracer &instance() {
+    static AllocationTracer *tracer = new AllocationTracer();
+    return *tracer;
+  }
+
+  static uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+  }
+
+  /// 记录分配，返回时间戳（调用方保存，释放时用于计算存活时间）
+  uint64_t on_allocate(const void *address, size_t size) {
+    const uint64_t now = now_ns();
+    live_count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t live = live_bytes_.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes_.compare_exchange_weak(
+                              peak, live, std::memory_order_relaxed)) {
+    }
+    ThreadSlot &slot = local_slot();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.push(now, address, size, TraceEvent::kAllocate);
+    ++slot.allocations;
+    ++slot.size_histogram[bucket(size)];
+    return now;
+  }
+
+  void on_free(const void *address, size_t size, uint64_t birth_ns) {
+    const uint64_t now = now_ns();
+    live_count_.fetch_sub(1, std::memory_order_relaxed);
+    live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+    const uint64_t lifetime = now - birth_ns;
+    ThreadSlot &slot = local_slot();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.push(now, address, size, TraceEvent::kFree);
+    ++slot.frees;
+    slot.lifetime_total_ns += lifetime;
+    ++slot.lifetime_histogram[bucket(lifetime)];
+  }
+
+  void on_move(const void *address, size_t size) {
+    const uint64_t now = now_ns();
+    ThreadSlot &slot = local_slot();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    slot.push(now, address, size, TraceEvent::kMove);
+    ++slot.moves;
+  }
+
+  /// 合并所有线程槽位（包括已退出线程留下的计数）
+  Summary summary() const {
+    Summary s;
+    s.live_count = live_count_.load(std::memory_order_relaxed);
+    s.live_bytes = live_bytes_.load(std::memory_order_relaxed);
+    s.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+    for (const auto &slot : slots_) {
+      std::lock_guard<std::mutex> lock(slot->mutex);
+      s.allocations += slot->allocations;
+      s.frees += slot->frees;
+      s.moves += slot->moves;
+      s.lifetime_total_ns += slot->lifetime_total_ns;
+      for (size_t i = 0; i < kNumBuckets; ++i) {
+        s.size_histogram[i] += slot->size_histogram[i];
+        s.lifetime_histogram[i] += slot->lifetime_histogram[i];
+      }
+    }
+    return s;
+  }
+
+  /// 各线程最近的事件，按时间排序
+  std::vector<TraceRecord> recent_events() const {
+    std::vector<TraceRecord> events;
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+    for (const auto &slot : slots_) {
+      std::lock_guard<std::mutex> lock(slot->mutex);
+      const uint64_t count = std::min<uint64_t>(slot->head, kRingCapacity);
+      for (uint64_t i = slot->head - count; i < slot->head; ++i) {
+        events.push_back(slot->ring[i % kRingCapacity]);
+      }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const TraceRecord &a, const TraceRecord &b) {
+                return a.timestamp_ns < b.timestamp_ns;
+              });
+    return events;
+  }
+
+  /// 清零计数、直方图和事件；live 个数/字节是状态而非计数，peak 重置为当前 live
+  void reset() {
+    peak_bytes_.store(live_bytes_.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+    for (const auto &slot : slots_) {
+      std::lock_guard<std::mutex> lock(slot->mutex);
+      slot->clear();
+    }
+  }
+
+  void print_summary(std::ostream &os) const {
+    Summary s = summary();
+    os << "[AllocationTracer] 分配 " << s.allocations << " 次, 释放 "
+       << s.frees << " 次, 移动 " << s.moves << " 次, 存活 "
+       << s.live_buffers() << " 个 / " << s.live_bytes << " 字节, 峰值 "
+       << s.peak_bytes << " 字节" << std::endl;
+    os << "  分配大小分布:" << std::endl;
+    print_histogram(os, s.size_histogram, "B");
+    if (s.frees > 0) {
+      os << "  存活时间分布: 平均 "
+         << static_cast<uint64_t>(s.mean_lifetime_ns()) << " ns, p50 <= "
+         << s.lifetime_percentile_ns(0.5) << " ns, p99 <= "
+         << s.lifetime_percentile_ns(0.99) << " ns" << std::endl;
+      print_histogram(os, s.lifetime_histogram, "ns");
+    }
+  }
+
+  AllocationTracer(const AllocationTracer &) = delete;
+  AllocationTracer &operator=(const AllocationTracer &) = delete;
+
+private:
+  /// 线程槽位：只有所属线程写入，汇总时由其他线程加锁读取
+  struct ThreadSlot {
+    std::mutex mutex;
+    uint32_t index = 0;
+    bool in_use = false; ///< 受 registry_mutex_ 保护
+    uint64_t head = 0;
+    std::array<TraceRecord, kRingCapacity> ring{};
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t moves = 0;
+    uint64_t lifetime_total_ns = 0;
+    std::array<uint64_t, kNumBuckets> size_histogram{};
+    std::array<uint64_t, kNumBuckets> lifetime_histogram{};
+
+    void push(uint64_t now, const void *address, size_t size,
+              TraceEvent event) {
+      ring[head % kRingCapacity] = TraceRecord{now, address, size, index, event};
+      ++head;
+    }
+
+    void clear() {
+      head = 0;
+      allocations = 0;
+      frees = 0;
+      moves = 0;
+      lifetime_total_ns = 0;
+      size_histogram.fill(0);
+      lifetime_histogram.fill(0);
+    }
+  };
+
+  /// 线程退出时把槽位标记为空闲，供新线程复用（计数保留，汇总不丢失）
+  struct SlotLease {
+    ThreadSlot *slot = nullptr;
+    ~SlotLease() {
+      if (slot != nullptr) {
+        AllocationTracer::instance().retire(slot);
+      }
+    }
+  };
+
+  AllocationTracer() = default;
+
+  static size_t bucket(uint64_t value) {
+    if (value < 2) {
+      return 0;
+    }
+    size_t b = 63 - static_cast<size_t>(__builtin_clzll(value));
+    return b < kNumBuckets ? b : kNumBuckets - 1;
+  }
+
+  /**
+   * 槽位指针本身是平凡的 thread_local，不会被析构：线程退出阶段
+   * （例如 TensorBufferPool 的线程缓存归还时）仍可安全记录。
+   */
+  ThreadSlot &local_slot() {
+    static thread_local ThreadSlot *slot = nullptr;
+    if (slot == nullptr) {
+      static thread_local SlotLease lease;
+      slot = claim();
+      lease.slot = slot;
+    }
+    return *slot;
+  }
+
+  ThreadSlot *claim() {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    for (const auto &slot : slots_) {
+      if (!slot->in_use) {
+        slot->in_use = true;
+        return slot.get();
+      }
+    }
+    slots_.push_back(std::make_unique<ThreadSlot>());
+    slots_.back()->index = static_cast<uint32_t>(slots_.size() - 1);
+    slots_.back()->in_use = true;
+    return slots_.back().get();
+  }
+
+  void retire(ThreadSlot *slot) {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    slot->in_use = false;
+  }
+
+  static void print_histogram(std::ostream &os,
+                              const std::array<uint64_t, kNumBuckets> &hist,
+                              const char *unit) {
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+      if (hist[i] != 0) {
+        os << "    [2^" << i << ", 2^" << i + 1 << ") " << unit << ": "
+           << hist[i] << std::endl;
+      }
+    }
+  }
+
+  std::atomic<uint64_t> live_count_{0};
+  std::atomic<uint64_t> live_bytes_{0};
+  std::atomic<uint64_t> peak_bytes_{0};
+  mutable std::mutex registry_mutex_;
+  std::vector<std::unique_ptr<ThreadSlot>> slots_;
+};
+
+#endif // ALLOCATION_TRACER_HPP
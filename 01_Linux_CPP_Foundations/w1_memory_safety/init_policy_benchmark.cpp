@@ -0,0 +1,120 @@
+/**
+ * @file init_policy_benchmark.cpp
+ * @brief SafeTensorBuffer 初始化策略基准 - 构造（填充）开销与首次访问延迟
+ *
+ * 对每种 TensorInit 策略测量：
+ * 1. 构造耗时：分配 + 初始化（memset / 内核预缺页）
+ * 2. 首次访问耗时：每页写 1 字节，此时未缺页的页面会触发缺页中断
+ * 3. 合计：对"构造后马上完整覆盖"的张量，哪种策略总代价最低
+ */
+
+#include "safe_tensor_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct InitResult {
+  double construct_ms = 0.0;
+  double first_touch_ms = 0.0;
+};
+
+const char *init_name(TensorInit init) {
+  switch (init) {
+  case TensorInit::kZero:
+    return "zero (memset)";
+  case TensorInit::kUninitialized:
+    return "uninitialized";
+  case TensorInit::kLazyZero:
+    return "lazy-zero (mmap)";
+  case TensorInit::kPrefault:
+    return "prefault (POPULATE)";
+  }
+  return "?";
+}
+
+double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+/// 构造 + 逐页首次写入，取多次运行的中位数
+InitResult measure(size_t size, TensorInit init, int repeats) {
+  std::vector<double> construct;
+  std::vector<double> touch;
+  const size_t page = SafeTensorBuffer::page_size();
+
+  for (int r = 0; r < repeats; ++r) {
+    auto start = Clock::now();
+    SafeTensorBuffer buffer(size, init);
+    construct.push_back(elapsed_ms(start));
+
+    start = Clock::now();
+    uint8_t *data = buffer.data();
+    for (size_t offset = 0; offset < size; offset += page) {
+      data[offset] = static_cast<uint8_t>(offset);
+    }
+    touch.push_back(elapsed_ms(start));
+    // 防止写入被优化掉
+    volatile uint8_t sink = data[size / 2];
+    (void)sink;
+  }
+
+  auto median = [](std::vector<double> &v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+  };
+  return {median(construct), median(touch)};
+}
+
+} // namespace
+
+int main() {
+  std::cout
+      << "╔══════════════════════════════════════════════════════════════╗"
+      << std::endl;
+  std::cout
+      << "║       SafeTensorBuffer 初始化策略基准（中位数，毫秒）        ║"
+      << std::endl;
+  std::cout
+      << "╚══════════════════════════════════════════════════════════════╝"
+      << std::endl;
+
+  const TensorInit policies[] = {TensorInit::kZero, TensorInit::kUninitialized,
+                                 TensorInit::kLazyZero, TensorInit::kPrefault};
+  const size_t sizes[] = {size_t{1} << 20, size_t{16} << 20,
+                          size_t{100} << 20};
+
+  for (size_t size : sizes) {
+    std::cout << "\n========== " << (size >> 20) << " MiB ==========\n"
+              << std::endl;
+    std::cout << std::left << std::setw(22) << "policy" << std::right
+              << std::setw(14) << "construct" << std::setw(14) << "first-touch"
+              << std::setw(12) << "total" << std::endl;
+    for (TensorInit init : policies) {
+      InitResult r = measure(size, init, 7);
+      std::cout << std::left << std::setw(22) << init_name(init) << std::right
+                << std::fixed << std::setprecision(3) << std::setw(14)
+                << r.construct_ms << std::setw(14) << r.first_touch_ms
+                << std::setw(12) << r.construct_ms + r.first_touch_ms
+                << std::endl;
+      std::cout.unsetf(std::ios::fixed);
+    }
+  }
+
+  std::cout << "\n说明：" << std::endl;
+  std::cout << "- zero / prefault 的缺页都发生在构造时，之后访问无缺页"
+            << std::endl;
+  std::cout << "- uninitialized / lazy-zero 构造几乎免费，缺页推迟到第一次写入"
+            << std::endl;
+  std::cout << "- malloc 的 mmap 阈值会动态上调（最多 32MB），释放后再分配的"
+            << std::endl;
+  std::cout << "  uninitialized 可能复用已缺页的堆内存，首次访问也很快"
+            << std::endl;
+  return 0;
+}
@@ -9,10 +9,29 @@
  * 2. 移动语义的正确应用
  * 3. 异常场景下的资源自动回收
  * 4. shared_ptr 引用计数与 weak_ptr 使用
+ * 5. SIMD 友好的对齐分配
+ * 6. 分级缓冲区池与线程本地缓存
+ * 7. 初始化策略（清零 / 不初始化 / 延迟清零 / 预缺页）
+ * 8. 分配后端（堆 / mmap / 透明大页 / hugetlb）
+ * 9. 文件映射的只读权重（零拷贝加载）
+ * 10. 带形状/步长的张量视图（TensorView）
+ * 11. 编译期形状的张量（StaticTensor）
+ * 12. 低开销的分配事件记录（AllocationTracer）
+ * 13. 向量化 fill / copy（运行时分派、非临时存储）
+ * 14. 引用计数的子缓冲区切片（零拷贝拆分 batch）
  */
 
+#include "mapped_tensor_file.hpp"
 #include "safe_tensor_buffer.hpp"
+#include "static_tensor.hpp"
+#include "tensor_buffer_pool.hpp"
+#include "tensor_buffer_slice.hpp"
+#include "tensor_view.hpp"
+#include <cstdio>
+#include <cstring>
 #include <functional>
+#include <thread>
+#include <utility>
 #include <vector>
 
 // =============================================================================
@@ -278,6 +297,488 @@ void test_vector_move() {
   std::cout << "vector 大小: " << buffers.size() << std::endl;
 }
 
+/**
+ * @brief 测试 8：对齐分配 - 满足 SIMD 对齐加载
+ *
+ * 【知识点】
+ * new uint8_t[n] 只保证 alignof(std::max_align_t)（x86-64 上为 16 字节）。
+ * AVX2 对齐加载要求 32 字节，AVX-512 要求 64 字节，否则触发 #GP 崩溃。
+ * C++17 的 operator new[](size, std::align_val_t) 可以指定对齐，
+ * 释放时必须用相同的对齐值调用 operator delete[]。
+ */
+void test_alignment() {
+  std::cout << "\n========== 测试 8: 对齐分配 ==========\n" << std::endl;
+
+  auto offset_of = [](const SafeTensorBuffer &buffer, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(buffer.data()) % alignment;
+  };
+
+  SafeTensorBuffer simd(1000); // 默认 64 字节对齐
+  std::cout << "默认对齐: " << simd.alignment()
+            << ", 地址 % 64 = " << offset_of(simd, 64) << std::endl;
+
+  SafeTensorBuffer small(1000, 16); // 小于 64 的请求按 64 处理
+  std::cout << "请求 16 字节对齐，实际: " << small.alignment() << std::endl;
+
+  const size_t page = SafeTensorBuffer::page_size();
+  SafeTensorBuffer paged(3 * page, page); // 页对齐
+  std::cout << "页对齐: " << paged.alignment() << ", 地址 % " << page
+            << " = " << offset_of(paged, page) << std::endl;
+
+  // 移动后对齐信息随数据一起转移，释放路径保持一致
+  SafeTensorBuffer moved(std::move(paged));
+  std::cout << "移动后对齐: " << moved.alignment() << std::endl;
+
+  try {
+    SafeTensorBuffer bad(1024, 48);
+  } catch (const std::invalid_argument &e) {
+    std::cout << "非 2 的幂对齐被拒绝: " << e.what() << std::endl;
+  }
+}
+
+/**
+ * @brief 测试 9：张量缓冲区池 - 每帧复用同几种尺寸
+ *
+ * 【知识点】
+ * 推理循环每帧申请/释放的尺寸几乎固定（输入、中间激活、输出）。
+ * 每次都走堆分配 + memset 是浪费：池把释放的缓冲区按 2 的幂分级缓存，
+ * 下一帧直接复用。线程本地链表命中时完全无锁。
+ * 删除器（TensorBufferDeleter）负责归还，使用方式与普通智能指针一样。
+ */
+void test_buffer_pool() {
+  std::cout << "\n========== 测试 9: 张量缓冲区池 ==========\n" << std::endl;
+
+  TensorBufferPool &pool = TensorBufferPool::instance();
+  pool.reset_stats();
+
+  // 每帧三种尺寸：640x640x3 输入、1x84x8400 float 输出、1MB 中间结果
+  const size_t kInput = 640 * 640 * 3;
+  const size_t kOutput = 1 * 84 * 8400 * sizeof(float);
+  const size_t kScratch = 1 << 20;
+
+  auto run_frames = [&](int frames) {
+    for (int i = 0; i < frames; ++i) {
+      UniqueTensorBuffer input = pool.acquire_unique(kInput);
+      TensorBufferPtr output = make_pooled_tensor_buffer(kOutput);
+      UniqueTensorBuffer scratch = pool.acquire_unique(kScratch);
+      input->data()[0] = static_cast<uint8_t>(i);
+    } // 三个句柄离开作用域，自动归还池中
+  };
+
+  std::cout << ">>> 主线程 1000 帧（只有第一帧会真正分配） <<<\n" << std::endl;
+  run_frames(1000);
+
+  std::cout << "\n>>> 工作线程 1000 帧（线程退出时缓存归还仓库） <<<\n"
+            << std::endl;
+  std::thread worker(run_frames, 1000);
+  worker.join();
+
+  std::cout << "\n>>> 第二个工作线程：从仓库取回，不再分配 <<<\n" << std::endl;
+  std::thread second(run_frames, 1000);
+  second.join();
+
+  TensorBufferPool::Stats stats = pool.stats();
+  std::cout << std::endl;
+  pool.print_stats(std::cout);
+  std::cout << "输入 " << kInput << " 字节 -> 级别容量 "
+            << TensorBufferPool::class_bytes(TensorBufferPool::size_class(kInput))
+            << " 字节" << std::endl;
+  std::cout << "所有句柄已归还: "
+            << (stats.releases == stats.acquires ? "是" : "否") << std::endl;
+
+  // trim() 同时清空主线程的本地缓存，闲置内存在这里就归还，而不是等到进程退出
+  pool.trim();
+  std::cout << "trim 后闲置: " << pool.stats().retained_bytes << " 字节"
+            << std::endl;
+}
+
+/**
+ * @brief 测试 10：初始化策略
+ *
+ * 【知识点】
+ * 构造时 memset 整块缓冲区有两个代价：多一遍内存带宽；
+ * 新页面的缺页中断全部集中在构造线程上。
+ * - 马上被完整覆盖的张量：kUninitialized
+ * - 需要全 0 但可能只用一部分：kLazyZero（匿名 mmap，内核按页清零）
+ * - 热路径上不允许缺页：kPrefault（MAP_POPULATE，构造时由内核一次性缺页）
+ */
+void test_init_policy() {
+  std::cout << "\n========== 测试 10: 初始化策略 ==========\n" << std::endl;
+
+  const size_t kSize = 1 << 20;
+  SafeTensorBuffer lazy(kSize, TensorInit::kLazyZero);
+  SafeTensorBuffer prefault(kSize, TensorInit::kPrefault);
+  SafeTensorBuffer raw(kSize, TensorInit::kUninitialized);
+  raw.fill(0x7F); // 未初始化的缓冲区必须先完整写入再读取
+
+  auto all_zero = [](const SafeTensorBuffer &buffer) {
+    for (size_t i = 0; i < buffer.size(); ++i) {
+      if (buffer.data()[i] != 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+  std::cout << "lazy-zero 全为 0: " << (all_zero(lazy) ? "是" : "否")
+            << std::endl;
+  std::cout << "prefault  全为 0: " << (all_zero(prefault) ? "是" : "否")
+            << std::endl;
+
+  // mmap 分配的缓冲区同样支持移动，释放时走 munmap
+  SafeTensorBuffer moved(std::move(lazy));
+  std::cout << "移动后策略保持为 lazy-zero: "
+            << (moved.init_policy() == TensorInit::kLazyZero ? "是" : "否")
+            << std::endl;
+  std::cout << "各策略的构造与首次访问耗时见 ./init_policy_benchmark"
+            << std::endl;
+}
+
+/**
+ * @brief 测试 11：分配后端 - 大张量使用大页
+ *
+ * 【知识点】
+ * 100MB 的张量用 4 KiB 页需要 25600 个页表项，TLB 根本装不下；
+ * 2 MiB 大页只需要 50 个。
+ * - kTransparentHugePages：mmap 后 madvise(MADV_HUGEPAGE)，内核尽量用大页
+ * - kHugeTlb：MAP_HUGETLB 从预留的大页池分配，池为空时回退到 THP
+ */
+void test_backends() {
+  std::cout << "\n========== 测试 11: 分配后端 ==========\n" << std::endl;
+
+  const size_t kSize = size_t{8} << 20;
+  SafeTensorBuffer thp(
+      kSize, TensorBufferOptions{64, TensorInit::kZero,
+                                 TensorBackend::kTransparentHugePages});
+  std::cout << "THP 地址按 2MiB 对齐: "
+            << (reinterpret_cast<uintptr_t>(thp.data()) % kHugePageSize == 0
+                    ? "是"
+                    : "否")
+            << std::endl;
+
+  SafeTensorBuffer huge(kSize, TensorBufferOptions{64, TensorInit::kZero,
+                                                   TensorBackend::kHugeTlb});
+  std::cout << "请求 hugetlb，实际后端: " << tensor_backend_name(huge.backend())
+            << std::endl;
+
+  for (TensorBackend backend :
+       {TensorBackend::kHeap, TensorBackend::kMmap,
+        TensorBackend::kTransparentHugePages, TensorBackend::kHugeTlb}) {
+    const TensorBackendCounters &c = tensor_backend_counters(backend);
+    std::cout << "  " << tensor_backend_name(backend)
+              << ": 分配 " << c.allocations.load() << " 次, 释放 "
+              << c.frees.load() << " 次, 回退 " << c.fallbacks.load() << " 次"
+              << std::endl;
+  }
+  std::cout << "各后端的跨页 / 随机访问耗时见 ./backend_benchmark" << std::endl;
+}
+
+/**
+ * @brief 测试 12：文件映射的只读权重
+ *
+ * 【知识点】
+ * "分配缓冲区 + read() 拷贝"加载权重：峰值内存 = 页缓存 + 堆上的副本。
+ * mmap 只读映射直接使用页缓存里的页面：
+ * - 零拷贝，多个进程加载同一模型时共享物理内存
+ * - 构造只建立映射，按需缺页读入；MAP_POPULATE / MADV_WILLNEED 可提前读入
+ * - mlock 让延迟敏感的模型常驻内存
+ */
+void test_mapped_weights() {
+  std::cout << "\n========== 测试 12: 文件映射的只读权重 ==========\n"
+            << std::endl;
+
+  // 构造一个"权重文件"：64 字节文件头 + 两个 float 张量
+  const std::string path = "/tmp/w1_weights.bin";
+  const size_t kHeader = 64;
+  const size_t kConvCount = 3 * 3 * 16;
+  const size_t kFcCount = 10000;
+  {
+    std::vector<float> conv(kConvCount, 0.5f);
+    std::vector<float> fc(kFcCount);
+    for (size_t i = 0; i < kFcCount; ++i) {
+      fc[i] = static_cast<float>(i);
+    }
+    std::vector<uint8_t> header(kHeader, 0);
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fwrite(header.data(), 1, header.size(), file);
+    std::fwrite(conv.data(), sizeof(float), conv.size(), file);
+    std::fwrite(fc.data(), sizeof(float), fc.size(), file);
+    std::fclose(file);
+  }
+
+  // 只映射全连接层：偏移不必页对齐
+  const size_t fc_offset = kHeader + kConvCount * sizeof(float);
+  MappedFileOptions options;
+  options.willneed = true;
+  options.lock = true;
+  MappedTensorFile fc(path, fc_offset, kFcCount * sizeof(float), options);
+  const float *weights = fc.view(0, fc.size()).as<float>();
+  std::cout << "fc[0] = " << weights[0] << ", fc[9999] = " << weights[9999]
+            << ", 已 mlock: " << (fc.locked() ? "是" : "否") << std::endl;
+
+  // 整个文件映射 + 子视图
+  MappedTensorFile whole(path);
+  ConstByteView conv = whole.view(kHeader, kConvCount * sizeof(float));
+  std::cout << "conv[0] = " << conv.as<float>()[0] << std::endl;
+
+  // 移动语义与 SafeTensorBuffer 一致
+  MappedTensorFile moved(std::move(whole));
+  std::cout << "移动后 whole.valid(): " << (whole.valid() ? "是" : "否")
+            << ", moved.size(): " << moved.size() << std::endl;
+
+  try {
+    moved.view(moved.size() - 4, 8);
+  } catch (const std::out_of_range &e) {
+    std::cout << "越界视图被拒绝: " << e.what() << std::endl;
+  }
+  std::remove(path.c_str()); // 已建立的映射不受删除文件影响
+}
+
+/**
+ * @brief 测试 13：带形状/步长的张量视图
+ *
+ * 【知识点】
+ * SafeTensorBuffer 负责所有权，TensorView<T> 只描述"怎么看"这块内存：
+ * - 元素地址 = data + Σ index[i] * stride[i]
+ * - slice / transpose / permute 只改指针和步长，不拷贝
+ * - 越界检查只在调试构建中存在（NDEBUG 下编译为空）
+ */
+void test_tensor_view() {
+  std::cout << "\n========== 测试 13: 张量视图（TensorView） ==========\n"
+            << std::endl;
+
+  // NCHW = 2x3x4x5 的 float 张量
+  SafeTensorBuffer buffer(2 * 3 * 4 * 5 * sizeof(float));
+  TensorView<float> nchw = make_tensor_view<float>(buffer, {2, 3, 4, 5});
+  for (size_t i = 0; i < nchw.numel(); ++i) {
+    nchw.data()[i] = static_cast<float>(i);
+  }
+  std::cout << "dtype: " << dtype_name(nchw.dtype()) << ", numel: "
+            << nchw.numel() << ", 连续: " << (nchw.is_contiguous() ? "是" : "否")
+            << std::endl;
+
+  // 第 1 张图的第 2 个通道：4x5 的平面，仍然连续
+  TensorView<float> plane = nchw.select(0, 1).select(0, 2);
+  std::cout << "plane(3, 4) = " << plane(3, 4) << " (期望 "
+            << nchw(1, 2, 3, 4) << "), 连续: "
+            << (plane.is_contiguous() ? "是" : "否") << std::endl;
+
+  // 隔列取样 + 转置：不连续，但与原数据共享内存
+  TensorView<float> strided = plane.slice(1, 0, 5, 2).transpose(0, 1);
+  std::cout << "slice+transpose 形状: " << strided.shape(0) << "x"
+            << strided.shape(1) << ", strided(2, 1) = " << strided(2, 1)
+            << ", 连续: " << (strided.is_contiguous() ? "是" : "否")
+            << std::endl;
+
+  // NCHW -> NHWC
+  TensorView<const float> nhwc = nchw.permute({0, 2, 3, 1});
+  std::cout << "NHWC 形状: " << nhwc.shape(0) << "x" << nhwc.shape(1) << "x"
+            << nhwc.shape(2) << "x" << nhwc.shape(3)
+            << ", nhwc(1, 3, 4, 2) = " << nhwc(1, 3, 4, 2) << std::endl;
+
+  strided(0, 0) = -1.0f; // 写穿到底层缓冲区
+  std::cout << "通过视图写入后 nchw(1, 2, 0, 0) = " << nchw(1, 2, 0, 0)
+            << std::endl;
+
+#ifndef NDEBUG
+  try {
+    plane(4, 0);
+  } catch (const std::out_of_range &e) {
+    std::cout << "调试构建越界检查: " << e.what() << std::endl;
+  }
+#else
+  std::cout << "发布构建（NDEBUG）：元素访问的越界检查已编译去除" << std::endl;
+#endif
+}
+
+/**
+ * @brief 测试 14：编译期形状的张量
+ *
+ * 【知识点】
+ * 部署模型的输入/输出几何是固定的（如 1x3x640x640、1x84x8400）：
+ * - 形状、步长、元素数都是 constexpr，可以 static_assert
+ * - 常量下标的地址计算在编译期折叠为一个立即数
+ * - view() 转为 TensorView，与动态 kernel 互通
+ */
+void test_static_tensor() {
+  std::cout << "\n========== 测试 14: 编译期形状的张量 ==========\n"
+            << std::endl;
+
+  using YoloOutput = StaticTensor<float, 1, 84, 8400>;
+  static_assert(YoloOutput::kStrides[1] == 8400, "stride of dim 1");
+  static_assert(YoloOutput::kNumel == 84 * 8400, "numel");
+  static_assert(YoloOutput::offset(0, 4, 100) == 4 * 8400 + 100, "offset");
+  std::cout << "YoloOutput: " << YoloOutput::kBytes << " 字节, 步长 {"
+            << YoloOutput::kStrides[0] << ", " << YoloOutput::kStrides[1]
+            << ", " << YoloOutput::kStrides[2] << "}" << std::endl;
+
+  YoloOutput out(TensorInit::kUninitialized);
+  // 内层循环边界与步长都是编译期常量
+  for (size_t c = 0; c < YoloOutput::kShape[1]; ++c) {
+    for (size_t i = 0; i < YoloOutput::kShape[2]; ++i) {
+      out(0, c, i) = static_cast<float>(c);
+    }
+  }
+
+  // 与动态视图互通：转置为 1x8400x84（每个候选框一行）
+  TensorView<const float> boxes = std::as_const(out).view().transpose(1, 2);
+  std::cout << "boxes 形状: " << boxes.shape(1) << "x" << boxes.shape(2)
+            << ", boxes(0, 7, 4) = " << boxes(0, 7, 4)
+            << ", 匹配 YoloOutput: " << (YoloOutput::matches(boxes) ? "是" : "否")
+            << ", 原视图匹配: "
+            << (YoloOutput::matches(std::as_const(out).view()) ? "是" : "否")
+            << std::endl;
+}
+
+/**
+ * @brief 测试 15：分配事件记录器
+ *
+ * 【知识点】
+ * std::cout << std::endl 每次都会 flush，并在全局流上串行化。
+ * AllocationTracer 把分配/释放/移动事件写到线程本地缓冲区，需要时再汇总：
+ * 存活/峰值字节数、分配大小分布、存活时间分布。
+ * SAFE_TENSOR_TRACE：0 关闭，1 只记录（默认），2 记录并逐条打印（本演示）。
+ */
+void test_allocation_tracer() {
+  std::cout << "\n========== 测试 15: 分配事件记录器 ==========\n"
+            << std::endl;
+
+  AllocationTracer &tracer = AllocationTracer::instance();
+  auto before_reset = std::make_unique<SafeTensorBuffer>(512);
+  tracer.reset();
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 2; ++t) {
+    workers.emplace_back([t] {
+      SafeTensorBuffer small(256 << t);
+      SafeTensorBuffer large((size_t{1} << 20) << t);
+      SafeTensorBuffer moved(std::move(large));
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  SafeTensorBuffer survivor(4096);
+  // reset 前分配、reset 后释放：本轮 frees 比 allocations 多，
+  // 存活个数仍来自 live 计数，而不是 allocations - frees
+  before_reset.reset();
+
+  std::cout << std::endl;
+  tracer.print_summary(std::cout);
+  AllocationTracer::Summary summary = tracer.summary();
+  std::cout << "存活个数与存活字节一致: "
+            << (summary.live_buffers() == 1 && summary.live_bytes == 4096
+                    ? "是"
+                    : "否")
+            << std::endl;
+  std::cout << "最近事件数: " << tracer.recent_events().size() << std::endl;
+}
+
+/**
+ * @brief 测试 16：向量化 fill / copy
+ *
+ * 【知识点】
+ * - 运行时分派：__builtin_cpu_supports 检测 AVX2 / AVX-512，
+ *   kernel 用 __attribute__((target(...))) 单独编译，不需要全局 -mavx512f
+ * - 目标超过末级缓存时用非临时存储（_mm512_stream_si512），
+ *   写入直接进内存，不把缓存里的权重/激活挤出去
+ * - memset 只能按字节填充；fill_as<float>(1.0f) 按元素填充
+ */
+void test_vector_kernels() {
+  std::cout << "\n========== 测试 16: 向量化 fill / copy ==========\n"
+            << std::endl;
+
+  std::cout << "指令集: " << simd_level_name(detect_simd_level())
+            << ", 非临时存储阈值: " << (default_nt_threshold() >> 20) << " MiB"
+            << std::endl;
+
+  SafeTensorBuffer ones(1000 * sizeof(float) + 2);
+  ones.fill_as(1.0f);
+  const auto *values = reinterpret_cast<const float *>(ones.data());
+  std::cout << "fill_as(1.0f): values[0] = " << values[0]
+            << ", values[999] = " << values[999] << std::endl;
+
+  // 元素大小 8、alignof 为 2：起点只按 alignof 对齐时块边界落在元素中间，
+  // tensor_fill 检查 sizeof(T) 对齐，不满足时逐元素填充
+  struct Rgba16 {
+    uint16_t r, g, b, a;
+  };
+  SafeTensorBuffer pixels(1024 + sizeof(Rgba16));
+  auto *shifted = reinterpret_cast<Rgba16 *>(pixels.data() + 2);
+  tensor_fill(shifted, Rgba16{1, 2, 3, 4}, 128);
+  bool pixels_ok = true;
+  for (size_t i = 0; i < 128; ++i) {
+    pixels_ok = pixels_ok && shifted[i].r == 1 && shifted[i].a == 4;
+  }
+  std::cout << "未按 sizeof(T) 对齐的 tensor_fill 结果正确: "
+            << (pixels_ok ? "是" : "否") << std::endl;
+
+  // 长度不是 64 的倍数也可以：中间按 64 字节块，头尾用 memcpy
+  SafeTensorBuffer copy(ones.size());
+  copy.copy_from(ones.data(), ones.size());
+  std::cout << "copy_from 后内容一致: "
+            << (std::memcmp(copy.data(), ones.data(), ones.size()) == 0 ? "是"
+                                                                         : "否")
+            << std::endl;
+
+  try {
+    copy.copy_from(ones.data(), ones.size() + 1);
+  } catch (const std::out_of_range &e) {
+    std::cout << "超长拷贝被拒绝: " << e.what() << std::endl;
+  }
+}
+
+/**
+ * @brief 测试 17：引用计数的子缓冲区切片
+ *
+ * 【知识点】
+ * batch 推理的输出是一块大缓冲区，每个请求只关心自己的那一帧。
+ * TensorBufferSlice = 父缓冲区的 shared_ptr + offset + length：
+ * - 下游只持有自己的切片，无需拷贝
+ * - 最后一个切片释放时父缓冲区才释放（池中的缓冲区则归还到池）
+ */
+void test_buffer_slices() {
+  std::cout << "\n========== 测试 17: 子缓冲区切片 ==========\n"
+            << std::endl;
+
+  constexpr size_t kBatch = 4;
+  constexpr size_t kFrameFloats = 3 * 8 * 8;
+  constexpr size_t kFrameBytes = kFrameFloats * sizeof(float);
+
+  std::vector<TensorBufferSlice> per_request;
+  TensorBufferWeakPtr batch_observer;
+  {
+    TensorBufferPtr batch = make_tensor_buffer(kBatch * kFrameBytes);
+    batch_observer = batch;
+    std::vector<TensorBufferSlice> slots =
+        split_batch(batch, kBatch, kFrameBytes);
+    for (size_t i = 0; i < kBatch; ++i) {
+      // "推理"：每个槽位写入自己的帧号
+      TensorView<float> frame = slots[i].view<float>({3, 8, 8});
+      tensor_fill(frame.data(), static_cast<float>(i), frame.numel());
+    }
+    std::cout << "batch 引用计数（1 + " << kBatch
+              << " 个切片）: " << batch.use_count() << std::endl;
+
+    // 只把第 1、3 帧交给下游请求，其余切片随作用域结束释放
+    per_request.push_back(slots[1]);
+    per_request.push_back(slots[3]);
+    std::cout << ">>> batch 与槽位离开作用域 <<<" << std::endl;
+  }
+
+  std::cout << "父缓冲区仍存活: " << (batch_observer.expired() ? "否" : "是")
+            << ", 引用计数: " << batch_observer.use_count() << std::endl;
+  for (const TensorBufferSlice &slice : per_request) {
+    TensorView<float> frame = slice.view<float>({3, 8, 8});
+    std::cout << "请求切片 offset=" << slice.offset()
+              << " 首元素 = " << frame(0, 0, 0) << std::endl;
+  }
+
+  std::cout << "\n>>> 释放最后的切片 <<<" << std::endl;
+  per_request.clear();
+  std::cout << "父缓冲区已释放: " << (batch_observer.expired() ? "是" : "否")
+            << std::endl;
+}
+
 // =============================================================================
 //                              主函数
 // =============================================================================
@@ -301,6 +802,16 @@ int main() {
     test_shared_ptr_passing();
     test_weak_ptr();
     test_vector_move();
+    test_alignment();
+    test_buffer_pool();
+    test_init_policy();
+    test_backends();
+    test_mapped_weights();
+    test_tensor_view();
+    test_static_tensor();
+    test_allocation_tracer();
+    test_vector_kernels();
+    test_buffer_slices();
 
     std::cout
         << "\n╔══════════════════════════════════════════════════════════════╗"
@@ -0,0 +1,188 @@
+/**
+ * @file mapped_tensor_file.hpp
+ * @brief MappedTensorFile - 文件映射的只读缓冲区（零拷贝加载模型权重）
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef MAPPED_TENSOR_FILE_HPP
+#define MAPPED_TENSOR_FILE_HPP
+
+#include "allocation_tracer.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// 映射选项
+struct MappedFileOptions {
+  bool populate = false; ///< MAP_POPULATE：映射时同步读入全部页面
+  bool willneed = false; ///< MADV_WILLNEED：异步预读，不阻塞构造
+  bool lock = false;     ///< mlock：常驻内存，不会被换出（受 RLIMIT_MEMLOCK 限制）
+};
+
+/// 只读字节视图（不拥有内存，生命周期不能超过 MappedTensorFile）
+struct ConstByteView {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+
+  template <typename T> const T *as() const {
+    return reinterpret_cast<const T *>(data);
+  }
+};
+
+/**
+ * @class MappedTensorFile
+ * @brief 把权重文件的一段区域映射为只读内存
+ *
+ * 特点：RAII 自动 munmap | 禁用拷贝 | 支持移动 | 与 SafeTensorBuffer 一致
+ *
+ * 与"分配 SafeTensorBuffer + read() 拷贝"相比：
+ * - 不需要额外的匿名内存，页面直接来自页缓存（多个进程加载同一模型时共享）
+ * - 构造只建立映射，按需缺页读入，启动快
+ */
+class MappedTensorFile {
+public:
+  /**
+   * @brief 映射文件 [offset, offset + length)
+   * @param path 文件路径
+   * @param offset 起始偏移（任意值，内部按页对齐映射）
+   * @param length 字节数；0 表示映射到文件末尾
+   */
+  explicit MappedTensorFile(const std::string &path, size_t offset = 0,
+                            size_t length = 0,
+                            const MappedFileOptions &options = {})
+      : data_(nullptr), size_(0), map_base_(nullptr), map_length_(0),
+        locked_(false) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(), "open " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "fstat " + path);
+    }
+    const auto file_size = static_cast<size_t>(st.st_size);
+    if (offset >= file_size || (length != 0 && length > file_size - offset)) {
+      ::close(fd);
+      throw std::out_of_range("MappedTensorFile: region exceeds file size");
+    }
+    size_ = length != 0 ? length : file_size - offset;
+
+    // mmap 的文件偏移必须按页对齐：向下取整，再把差值加回指针
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t aligned_offset = offset / page * page;
+    const size_t delta = offset - aligned_offset;
+    map_length_ = size_ + delta;
+
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      std::cout << "[MappedTensorFile] 映射: " << path << " [" << offset
+                << ", " << offset + size_ << ")" << std::endl;
+    }
+
+    void *base = ::mmap(nullptr, map_length_, PROT_READ,
+                        MAP_PRIVATE | (options.populate ? MAP_POPULATE : 0),
+                        fd, static_cast<off_t>(aligned_offset));
+    int map_errno = errno;
+    ::close(fd); // 映射建立后即可关闭 fd，映射仍然有效
+    if (base == MAP_FAILED) {
+      throw std::system_error(map_errno, std::generic_category(), "mmap");
+    }
+    map_base_ = static_cast<uint8_t *>(base);
+    data_ = map_base_ + delta;
+
+    if (options.willneed) {
+      ::madvise(map_base_, map_length_, MADV_WILLNEED);
+    }
+    if (options.lock) {
+      if (::mlock(map_base_, map_length_) != 0) {
+        int err = errno;
+        ::munmap(map_base_, map_length_);
+        throw std::system_error(err, std::generic_category(), "mlock");
+      }
+      locked_ = true;
+    }
+  }
+
+  /// 析构函数 - 自动解除映射（munmap 同时解除 mlock）
+  ~MappedTensorFile() {
+    if (map_base_ != nullptr) {
+      if constexpr (kSafeTensorTraceLevel >= 2) {
+        std::cout << "[MappedTensorFile] 解除映射: " << size_ << " 字节"
+                  << std::endl;
+      }
+      ::munmap(map_base_, map_length_);
+    }
+  }
+
+  // 禁用拷贝
+  MappedTensorFile(const MappedTensorFile &) = delete;
+  MappedTensorFile &operator=(const MappedTensorFile &) = delete;
+
+  /// 移动构造（转移映射所有权）
+  MappedTensorFile(MappedTensorFile &&other) noexcept
+      : data_(other.data_), size_(other.size_), map_base_(other.map_base_),
+        map_length_(other.map_length_), locked_(other.locked_) {
+    other.reset();
+  }
+
+  /// 移动赋值
+  MappedTensorFile &operator=(MappedTensorFile &&other) noexcept {
+    if (this != &other) {
+      if (map_base_ != nullptr) {
+        ::munmap(map_base_, map_length_);
+      }
+      data_ = other.data_;
+      size_ = other.size_;
+      map_base_ = other.map_base_;
+      map_length_ = other.map_length_;
+      locked_ = other.locked_;
+      other.reset();
+    }
+    return *this;
+  }
+
+  // 访问接口（只读）
+  const uint8_t *data() const noexcept { return data_; }
+  size_t size() const noexcept { return size_; }
+  bool valid() const noexcept { return data_ != nullptr; }
+  bool locked() const noexcept { return locked_; }
+
+  /**
+   * @brief 映射区域内的子视图，例如权重文件中的某一个张量
+   * @throws std::out_of_range 越界
+   */
+  ConstByteView view(size_t offset, size_t length) const {
+    if (offset > size_ || length > size_ - offset) {
+      throw std::out_of_range("MappedTensorFile: view out of range");
+    }
+    return ConstByteView{data_ + offset, length};
+  }
+
+private:
+  void reset() noexcept {
+    data_ = nullptr;
+    size_ = 0;
+    map_base_ = nullptr;
+    map_length_ = 0;
+    locked_ = false;
+  }
+
+  const uint8_t *data_; ///< 用户请求的起始位置
+  size_t size_;
+  uint8_t *map_base_;   ///< 页对齐的映射起点（munmap 使用）
+  size_t map_length_;
+  bool locked_;
+};
+
+#endif // MAPPED_TENSOR_FILE_HPP
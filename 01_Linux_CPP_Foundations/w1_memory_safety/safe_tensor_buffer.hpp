@@ -7,49 +7,180 @@
 #ifndef SAFE_TENSOR_BUFFER_HPP
 #define SAFE_TENSOR_BUFFER_HPP
 
+#include "allocation_tracer.hpp"
+#include "tensor_kernels.hpp"
+
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <stdexcept>
 
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief 缓冲区初始化策略
+ *
+ * | 策略           | 分配方式               | 内容   | 缺页发生在       |
+ * |----------------|------------------------|--------|------------------|
+ * | kZero          | 对齐 new + memset      | 全 0   | 构造时（memset） |
+ * | kUninitialized | 对齐 new               | 未定义 | 第一次写入时     |
+ * | kLazyZero      | 匿名 mmap              | 全 0   | 第一次访问时     |
+ * | kPrefault      | 匿名 mmap+MAP_POPULATE | 全 0   | 构造时（内核）   |
+ */
+enum class TensorInit {
+  kZero,          ///< 显式清零（默认，与旧行为一致）
+  kUninitialized, ///< 不初始化：马上会被完整覆盖的张量
+  kLazyZero,      ///< 内核按页清零，不访问的页不占物理内存
+  kPrefault,      ///< 构造时一次性预先缺页，热路径上不再缺页
+};
+
+/**
+ * @brief 分配后端
+ *
+ * 24~100MB 的激活/帧缓冲区用 4 KiB 页时需要 6000~25000 个 TLB 表项，
+ * 远超 L2 TLB 容量（~1500），跨页访问频繁 TLB miss。2 MiB 大页只需几十个。
+ */
+enum class TensorBackend {
+  kHeap,                 ///< 对齐 new（默认）
+  kMmap,                 ///< 匿名 mmap，4 KiB 页
+  kTransparentHugePages, ///< 匿名 mmap + madvise(MADV_HUGEPAGE)，2 MiB 对齐
+  kHugeTlb,              ///< mmap(MAP_HUGETLB)，需预留大页；失败时回退到 THP
+};
+
+constexpr size_t kNumTensorBackends = 4;
+
+/// x86-64 / aarch64 的默认大页大小
+constexpr size_t kHugePageSize = size_t{2} << 20;
+
+inline const char *tensor_backend_name(TensorBackend backend) {
+  switch (backend) {
+  case TensorBackend::kHeap:
+    return "heap";
+  case TensorBackend::kMmap:
+    return "mmap";
+  case TensorBackend::kTransparentHugePages:
+    return "thp";
+  case TensorBackend::kHugeTlb:
+    return "hugetlb";
+  }
+  return "?";
+}
+
+/// 每个后端的计数（relaxed 原子，进程内全局）
+struct TensorBackendCounters {
+  std::atomic<uint64_t> allocations{0}; ///< 以该后端成功分配的次数
+  std::atomic<uint64_t> bytes{0};       ///< 累计分配字节数
+  std::atomic<uint64_t> frees{0};       ///< 释放次数
+  std::atomic<uint64_t> fallbacks{0};   ///< 该后端失败、回退到其他后端的次数
+};
+
+inline TensorBackendCounters &tensor_backend_counters(TensorBackend backend) {
+  static TensorBackendCounters counters[kNumTensorBackends];
+  return counters[static_cast<size_t>(backend)];
+}
+
+/// 构造选项：对齐、初始化策略、分配后端
+struct TensorBufferOptions {
+  size_t alignment = 64; ///< 同 SafeTensorBuffer::kMinAlignment
+  TensorInit init = TensorInit::kZero;
+  TensorBackend backend = TensorBackend::kHeap;
+};
+
 /**
  * @class SafeTensorBuffer
  * @brief 模拟显存/内存的安全管理类
  *
- * 特点：RAII 自动释放 | 禁用拷贝 | 支持移动 | 异常安全
+ * 特点：RAII 自动释放 | 禁用拷贝 | 支持移动 | 异常安全 | 可配置对齐 |
+ *       可选初始化策略 | 可选分配后端（堆 / mmap / 大页）
+ *
+ * 生命周期事件交给 AllocationTracer（SAFE_TENSOR_TRACE 控制），
+ * 只有级别 2 才逐条输出到 std::cout。
  */
 class SafeTensorBuffer {
 public:
-  /// 构造函数 - 分配内存
-  explicit SafeTensorBuffer(size_t size) : size_(size), data_(nullptr) {
+  /// 最小对齐：一条缓存行，也满足 AVX-512 对齐加载（64 字节）
+  static constexpr size_t kMinAlignment = 64;
+
+  /// 页大小（页对齐的缓冲区可用于 mmap / DMA / 大页场景）
+  static size_t page_size() noexcept {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+  }
+
+  /**
+   * @brief 构造函数 - 按指定对齐分配内存
+   * @param size 字节数（不能为 0）
+   * @param alignment 对齐字节数，必须是 2 的幂；小于 kMinAlignment 时按 64 处理
+   * @param init 初始化策略（见 TensorInit）
+   *
+   * 普通 new uint8_t[] 只保证 16 字节对齐（alignof(max_align_t)），
+   * AVX2/AVX-512 的对齐加载（_mm256_load_ps / _mm512_load_ps）会因此崩溃。
+   */
+  explicit SafeTensorBuffer(size_t size, size_t alignment = kMinAlignment,
+                            TensorInit init = TensorInit::kZero)
+      : SafeTensorBuffer(size,
+                         TensorBufferOptions{alignment, init,
+                                             TensorBackend::kHeap}) {}
+
+  /// 只指定初始化策略，使用默认对齐
+  SafeTensorBuffer(size_t size, TensorInit init)
+      : SafeTensorBuffer(size, kMinAlignment, init) {}
+
+  /**
+   * @brief 完整构造：对齐 + 初始化策略 + 分配后端
+   *
+   * - kLazyZero / kPrefault 依赖 mmap，堆后端时自动改用 kMmap
+   * - mmap 类后端的页由内核清零，kZero 不再需要 memset
+   * - kHugeTlb 没有预留大页（/proc/sys/vm/nr_hugepages）时回退到 THP，
+   *   backend() 返回实际使用的后端
+   */
+  SafeTensorBuffer(size_t size, const TensorBufferOptions &options)
+      : size_(size), alignment_(checked_alignment(options.alignment)),
+        init_(options.init), backend_(options.backend), mapped_length_(0),
+        birth_ns_(0), data_(nullptr) {
     if (size == 0) {
       throw std::invalid_argument("Buffer size cannot be zero");
     }
 
-    std::cout << "[SafeTensorBuffer] 构造: 分配 " << size << " 字节"
-              << std::endl;
-
-    data_ = new (std::nothrow) uint8_t[size];
-    if (data_ == nullptr) {
-      throw std::bad_alloc();
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      std::cout << "[SafeTensorBuffer] 构造: 分配 " << size << " 字节, "
+                << alignment_ << " 字节对齐";
+      if (backend_ != TensorBackend::kHeap) {
+        std::cout << ", 后端 " << tensor_backend_name(backend_);
+      }
+      std::cout << std::endl;
     }
 
-    std::memset(data_, 0, size);
-    std::cout << "[SafeTensorBuffer] 地址 = " << static_cast<void *>(data_)
-              << std::endl;
+    allocate();
+    tensor_backend_counters(backend_).allocations.fetch_add(
+        1, std::memory_order_relaxed);
+    tensor_backend_counters(backend_).bytes.fetch_add(
+        size_, std::memory_order_relaxed);
+    if constexpr (kSafeTensorTraceLevel >= 1) {
+      birth_ns_ = AllocationTracer::instance().on_allocate(data_, size_);
+    }
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      std::cout << "[SafeTensorBuffer] 地址 = " << static_cast<void *>(data_)
+                << std::endl;
+    }
   }
 
   /// 析构函数 - 自动释放内存
   ~SafeTensorBuffer() {
-    if (data_ != nullptr) {
-      std::cout << "[SafeTensorBuffer] 析构: 释放 " << size_ << " 字节"
-                << std::endl;
-      delete[] data_;
-      data_ = nullptr;
-    } else {
-      std::cout << "[SafeTensorBuffer] 析构: 对象已被移动" << std::endl;
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      if (data_ != nullptr) {
+        std::cout << "[SafeTensorBuffer] 析构: 释放 " << size_ << " 字节"
+                  << std::endl;
+      } else {
+        std::cout << "[SafeTensorBuffer] 析构: 对象已被移动" << std::endl;
+      }
     }
+    release();
   }
 
   // 禁用拷贝（深拷贝代价高昂）
@@ -58,20 +189,37 @@ public:
 
   /// 移动构造（零拷贝转移所有权）
   SafeTensorBuffer(SafeTensorBuffer &&other) noexcept
-      : size_(other.size_), data_(other.data_) {
-    std::cout << "[SafeTensorBuffer] 移动构造: 从 "
-              << static_cast<void *>(other.data_) << " 转移" << std::endl;
+      : size_(other.size_), alignment_(other.alignment_), init_(other.init_),
+        backend_(other.backend_), mapped_length_(other.mapped_length_),
+        birth_ns_(other.birth_ns_), data_(other.data_) {
+    if constexpr (kSafeTensorTraceLevel >= 1) {
+      AllocationTracer::instance().on_move(data_, size_);
+    }
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      std::cout << "[SafeTensorBuffer] 移动构造: 从 "
+                << static_cast<void *>(other.data_) << " 转移" << std::endl;
+    }
     other.size_ = 0;
+    other.mapped_length_ = 0;
     other.data_ = nullptr;
   }
 
   /// 移动赋值
   SafeTensorBuffer &operator=(SafeTensorBuffer &&other) noexcept {
     if (this != &other) {
-      delete[] data_;
+      release();
       size_ = other.size_;
+      alignment_ = other.alignment_;
+      init_ = other.init_;
+      backend_ = other.backend_;
+      mapped_length_ = other.mapped_length_;
+      birth_ns_ = other.birth_ns_;
       data_ = other.data_;
+      if constexpr (kSafeTensorTraceLevel >= 1) {
+        AllocationTracer::instance().on_move(data_, size_);
+      }
       other.size_ = 0;
+      other.mapped_length_ = 0;
       other.data_ = nullptr;
     }
     return *this;
@@ -83,14 +231,164 @@ public:
   size_t size() const noexcept { return size_; }
   bool valid() const noexcept { return data_ != nullptr; }
 
+  /// 实际对齐字节数，kernel 据此选择对齐加载的快速路径
+  size_t alignment() const noexcept { return alignment_; }
+
+  /// 构造时使用的初始化策略
+  TensorInit init_policy() const noexcept { return init_; }
+
+  /// 实际使用的分配后端（kHugeTlb 回退后为 kTransparentHugePages）
+  TensorBackend backend() const noexcept { return backend_; }
+
+  /// 按字节填充（向量化，超过末级缓存时用非临时存储）
   void fill(uint8_t value) {
     if (data_ != nullptr) {
-      std::memset(data_, value, size_);
+      tensor_fill_bytes(data_, value, size_);
+    }
+  }
+
+  /// 按元素填充，例如 fill_as(1.0f)；末尾不足一个元素的字节不变
+  template <typename T> void fill_as(T value) {
+    if (data_ != nullptr) {
+      tensor_fill(reinterpret_cast<T *>(data_), value, size_ / sizeof(T));
+    }
+  }
+
+  /**
+   * @brief 从 src 拷贝 bytes 字节到缓冲区开头
+   * @throws std::out_of_range bytes 超过缓冲区大小
+   */
+  void copy_from(const void *src, size_t bytes) {
+    if (bytes > size_) {
+      throw std::out_of_range("copy_from: source larger than buffer");
     }
+    tensor_copy(data_, src, bytes);
   }
 
 private:
+  static size_t checked_alignment(size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+      throw std::invalid_argument("Alignment must be a power of two");
+    }
+    return alignment < kMinAlignment ? kMinAlignment : alignment;
+  }
+
+  /// 按后端分配 data_；失败抛 std::bad_alloc
+  void allocate() {
+    const bool prefault = init_ == TensorInit::kPrefault;
+    if (backend_ == TensorBackend::kHeap &&
+        (init_ == TensorInit::kLazyZero || prefault)) {
+      backend_ = TensorBackend::kMmap;
+    }
+
+    switch (backend_) {
+    case TensorBackend::kHeap:
+      // C++17 对齐 new：释放时必须传入相同的对齐值
+      data_ = static_cast<uint8_t *>(::operator new[](
+          size_, std::align_val_t(alignment_), std::nothrow));
+      if (data_ == nullptr) {
+        throw std::bad_alloc();
+      }
+      if (init_ == TensorInit::kZero) {
+        std::memset(data_, 0, size_);
+      }
+      return;
+
+    case TensorBackend::kMmap:
+      // 匿名映射的页由内核保证为 0，无需 memset
+      data_ = map_anonymous(alignment_, page_size(),
+                            prefault ? MAP_POPULATE : 0);
+      break;
+
+    case TensorBackend::kHugeTlb:
+      data_ = map_anonymous(alignment_, kHugePageSize,
+                            MAP_HUGETLB | (prefault ? MAP_POPULATE : 0));
+      if (data_ != nullptr) {
+        return;
+      }
+      // 没有预留大页：回退到透明大页
+      tensor_backend_counters(TensorBackend::kHugeTlb)
+          .fallbacks.fetch_add(1, std::memory_order_relaxed);
+      backend_ = TensorBackend::kTransparentHugePages;
+      [[fallthrough]];
+
+    case TensorBackend::kTransparentHugePages:
+      // 起始地址和长度都按 2 MiB 对齐，整个区间才能由大页映射
+      data_ = map_anonymous(alignment_ > kHugePageSize ? alignment_
+                                                       : kHugePageSize,
+                            kHugePageSize, 0, page_size());
+      if (data_ != nullptr) {
+        madvise(data_, mapped_length_, MADV_HUGEPAGE);
+        if (prefault) {
+          // MAP_POPULATE 发生在 madvise 之前，只会得到 4 KiB 页，改为逐页写入
+          for (size_t offset = 0; offset < mapped_length_;
+               offset += page_size()) {
+            data_[offset] = 0;
+          }
+        }
+      }
+      break;
+    }
+    if (data_ == nullptr) {
+      throw std::bad_alloc();
+    }
+  }
+
+  /**
+   * @brief 匿名映射至少 size_ 字节（长度取整到 granule），起始地址按 align 对齐
+   * @param natural mmap 天然保证的对齐（页或大页）；默认等于 granule
+   * @return 失败返回 nullptr
+   *
+   * 要求的对齐超过天然对齐时多映射 align 字节，再把头尾多余的部分 munmap 掉。
+   */
+  uint8_t *map_anonymous(size_t align, size_t granule, int extra_flags,
+                         size_t natural = 0) {
+    natural = natural == 0 ? granule : natural;
+    const size_t length = (size_ + granule - 1) / granule * granule;
+    const size_t slack = align > natural ? align : 0;
+    void *raw = mmap(nullptr, length + slack, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    if (raw == MAP_FAILED) {
+      return nullptr;
+    }
+    auto base = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = base;
+    if (slack != 0) {
+      aligned = (base + slack - 1) & ~(uintptr_t{slack} - 1);
+      if (aligned > base) {
+        munmap(raw, aligned - base);
+      }
+      size_t tail = base + length + slack - (aligned + length);
+      if (tail > 0) {
+        munmap(reinterpret_cast<void *>(aligned + length), tail);
+      }
+    }
+    mapped_length_ = length;
+    return reinterpret_cast<uint8_t *>(aligned);
+  }
+
+  void release() noexcept {
+    if (data_ != nullptr) {
+      tensor_backend_counters(backend_).frees.fetch_add(
+          1, std::memory_order_relaxed);
+      if constexpr (kSafeTensorTraceLevel >= 1) {
+        AllocationTracer::instance().on_free(data_, size_, birth_ns_);
+      }
+      if (mapped_length_ != 0) {
+        munmap(data_, mapped_length_);
+      } else {
+        ::operator delete[](data_, std::align_val_t(alignment_));
+      }
+      data_ = nullptr;
+    }
+  }
+
   size_t size_;
+  size_t alignment_;
+  TensorInit init_;
+  TensorBackend backend_;
+  size_t mapped_length_; ///< 非 0 表示由 mmap 分配
+  uint64_t birth_ns_;    ///< 分配时间戳（AllocationTracer 计算存活时间）
   uint8_t *data_;
 };
 
@@ -102,14 +400,29 @@ using TensorBufferPtr = std::shared_ptr<SafeTensorBuffer>;
 using TensorBufferWeakPtr = std::weak_ptr<SafeTensorBuffer>;
 
 /// 创建 shared_ptr 管理的 SafeTensorBuffer
-inline TensorBufferPtr make_tensor_buffer(size_t size) {
-  return std::make_shared<SafeTensorBuffer>(size);
+inline TensorBufferPtr
+make_tensor_buffer(size_t size,
+                   size_t alignment = SafeTensorBuffer::kMinAlignment) {
+  return std::make_shared<SafeTensorBuffer>(size, alignment);
 }
 
-/// 自定义删除器示例
+/**
+ * @brief 自定义删除器
+ *
+ * recycle 为空时直接 delete；非空时把缓冲区交还给它（例如 TensorBufferPool），
+ * 这样 UniqueTensorBuffer / shared_ptr 离开作用域即自动归还到池中。
+ */
 struct TensorBufferDeleter {
+  void (*recycle)(SafeTensorBuffer *) = nullptr;
+
   void operator()(SafeTensorBuffer *ptr) const {
-    std::cout << "[TensorBufferDeleter] 自定义删除器" << std::endl;
+    if (recycle != nullptr) {
+      recycle(ptr);
+      return;
+    }
+    if constexpr (kSafeTensorTraceLevel >= 2) {
+      std::cout << "[TensorBufferDeleter] 自定义删除器" << std::endl;
+    }
     delete ptr;
   }
 };
@@ -0,0 +1,137 @@
+/**
+ * @file static_tensor.hpp
+ * @brief StaticTensor<T, Dims...> - 编译期形状的张量（constexpr 形状/步长/大小）
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef STATIC_TENSOR_HPP
+#define STATIC_TENSOR_HPP
+
+#include "safe_tensor_buffer.hpp"
+#include "tensor_view.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+/// 行主序步长：最后一维步长为 1
+template <size_t... Dims>
+constexpr std::array<size_t, sizeof...(Dims)> row_major_strides() {
+  std::array<size_t, sizeof...(Dims)> shape{Dims...};
+  std::array<size_t, sizeof...(Dims)> strides{};
+  size_t stride = 1;
+  for (size_t d = sizeof...(Dims); d-- > 0;) {
+    strides[d] = stride;
+    stride *= shape[d];
+  }
+  return strides;
+}
+
+/**
+ * @class StaticTensor
+ * @brief 固定几何的张量，例如 StaticTensor<float, 1, 3, 640, 640>
+ *
+ * - 形状、步长、元素数都是 constexpr，offset(n, c, h, w) 在编译期可求值；
+ *   下标为常量时整个地址计算折叠为一个立即数，循环边界已知便于展开/向量化
+ * - 内存由成员 SafeTensorBuffer 持有：同样的 RAII、禁用拷贝、支持移动
+ * - view() 转为动态 TensorView，与通用 kernel 互通
+ */
+template <typename T, size_t... Dims> class StaticTensor {
+  static_assert(sizeof...(Dims) >= 1 && sizeof...(Dims) <= kMaxTensorRank,
+                "StaticTensor: rank must be in [1, kMaxTensorRank]");
+  static_assert(((Dims > 0) && ...), "StaticTensor: extents must be positive");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "StaticTensor: element type must be trivially copyable");
+
+public:
+  static constexpr size_t kRank = sizeof...(Dims);
+  static constexpr std::array<size_t, kRank> kShape{Dims...};
+  static constexpr std::array<size_t, kRank> kStrides =
+      row_major_strides<Dims...>();
+  static constexpr size_t kNumel = (Dims * ...);
+  static constexpr size_t kBytes = kNumel * sizeof(T);
+
+  /// 编译期偏移（单位：元素），不做越界检查
+  template <typename... Index> static constexpr size_t offset(Index... index) {
+    static_assert(sizeof...(Index) == kRank,
+                  "StaticTensor: index count does not match rank");
+    return offset_impl(std::make_index_sequence<kRank>{},
+                       static_cast<size_t>(index)...);
+  }
+
+  explicit StaticTensor(TensorInit init = TensorInit::kZero)
+      : buffer_(kBytes, SafeTensorBuffer::kMinAlignment, init) {}
+
+  explicit StaticTensor(const TensorBufferOptions &options)
+      : buffer_(kBytes, options) {}
+
+  T *data() noexcept { return reinterpret_cast<T *>(buffer_.data()); }
+  const T *data() const noexcept {
+    return reinterpret_cast<const T *>(buffer_.data());
+  }
+
+  /// 底层缓冲区（例如交给只认识 SafeTensorBuffer 的接口）
+  SafeTensorBuffer &buffer() noexcept { return buffer_; }
+  const SafeTensorBuffer &buffer() const noexcept { return buffer_; }
+
+  /// 元素访问；越界检查与 TensorView 相同，仅在调试构建中存在
+  template <typename... Index> T &operator()(Index... index) {
+    check_bounds(std::make_index_sequence<kRank>{},
+                 static_cast<size_t>(index)...);
+    return data()[offset(index...)];
+  }
+
+  template <typename... Index> const T &operator()(Index... index) const {
+    check_bounds(std::make_index_sequence<kRank>{},
+                 static_cast<size_t>(index)...);
+    return data()[offset(index...)];
+  }
+
+  /// 转为动态视图
+  TensorView<T> view() { return make_view<T>(data()); }
+  TensorView<const T> view() const { return make_view<const T>(data()); }
+
+  /// 动态视图的形状是否与本类型一致（kernel 据此选择静态特化路径）
+  static bool matches(const TensorView<const T> &view) {
+    if (view.rank() != kRank) {
+      return false;
+    }
+    for (size_t d = 0; d < kRank; ++d) {
+      if (view.shape()[d] != kShape[d]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  template <size_t... I, typename... Index>
+  static constexpr size_t offset_impl(std::index_sequence<I...>,
+                                      Index... index) {
+    return ((index * kStrides[I]) + ... + 0);
+  }
+
+  template <size_t... I, typename... Index>
+  static void check_bounds(std::index_sequence<I...>,
+                           [[maybe_unused]] Index... index) {
+#ifndef NDEBUG
+    (TENSOR_VIEW_CHECK(index < kShape[I], "StaticTensor: index out of range"),
+     ...);
+#endif
+  }
+
+  template <typename U> static TensorView<U> make_view(U *data) {
+    typename TensorView<U>::Shape shape{};
+    typename TensorView<U>::Strides strides{};
+    for (size_t d = 0; d < kRank; ++d) {
+      shape[d] = kShape[d];
+      strides[d] = static_cast<ptrdiff_t>(kStrides[d]);
+    }
+    return TensorView<U>(data, kRank, shape, strides);
+  }
+
+  SafeTensorBuffer buffer_;
+};
+
+#endif // STATIC_TENSOR_HPP
@@ -0,0 +1,473 @@
+/**
+ * @file tensor_buffer_pool.hpp
+ * @brief TensorBufferPool - 按 2 的幂分级的 SafeTensorBuffer 对象池
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef TENSOR_BUFFER_POOL_HPP
+#define TENSOR_BUFFER_POOL_HPP
+
+#include "safe_tensor_buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class TensorBufferPool
+ * @brief 推理循环中反复申请/释放同几种尺寸的张量时，复用已分配的缓冲区
+ *
+ * 结构（与 tcmalloc 的 thread cache + central list 相同的思路）：
+ * - 尺寸分级：向上取到 2 的幂，最小 256B，最大 1GiB（更大的不入池）
+ * - 线程本地空闲链表：命中时无锁、无系统调用、无 memset，也没有共享原子操作
+ * - 共享仓库（depot）：本地链表超过上限时把一半还给仓库，本地为空时从仓库批量取
+ *
+ * 注意：
+ * - 池中取出的缓冲区 size() 是所在级别的容量（≥ 请求值）
+ * - 复用的缓冲区不会被重新清零，需要时自行 fill(0)
+ * - 非默认对齐的请求不入池，直接分配
+ * - 池或当前线程的缓存已析构（例如全局 TensorBufferPtr 在退出阶段才释放）时，
+ *   归还退化为直接 delete
+ */
+class TensorBufferPool {
+public:
+  static constexpr size_t kMinClassShift = 8;  // 256B
+  static constexpr size_t kMaxClassShift = 30; // 1GiB
+  static constexpr size_t kNumClasses = kMaxClassShift - kMinClassShift + 1;
+  /// 每个线程（所有级别合计）最多缓存的字节数；单个超过它的缓冲区直接进仓库
+  static constexpr size_t kLocalCacheBytes = size_t{32} << 20;
+  /// 每个线程每个级别最多缓存的缓冲区个数
+  static constexpr size_t kLocalCacheCount = 16;
+  /// 仓库保留的总字节数上限，超出的归还直接释放
+  static constexpr size_t kMaxDepotBytes = size_t{512} << 20;
+
+  /// 统计快照
+  struct Stats {
+    uint64_t acquires = 0;         ///< 请求次数
+    uint64_t local_hits = 0;       ///< 线程本地链表命中
+    uint64_t depot_hits = 0;       ///< 共享仓库命中
+    uint64_t heap_allocations = 0; ///< 未命中，真正分配的次数
+    uint64_t bypass = 0;           ///< 不入池的请求（过大或特殊对齐）
+    uint64_t releases = 0;         ///< 归还次数
+    uint64_t retained_bytes = 0;   ///< 池中闲置的字节数（本地 + 仓库）
+    double elapsed_seconds = 0.0;  ///< 自 reset_stats() 以来的时间
+
+    double hit_rate() const {
+      return acquires == 0 ? 0.0
+                           : static_cast<double>(local_hits + depot_hits) /
+                                 static_cast<double>(acquires);
+    }
+    double acquire_rate() const {
+      return elapsed_seconds <= 0.0
+                 ? 0.0
+                 : static_cast<double>(acquires) / elapsed_seconds;
+    }
+    double heap_allocation_rate() const {
+      return elapsed_seconds <= 0.0
+                 ? 0.0
+                 : static_cast<double>(heap_allocations) / elapsed_seconds;
+    }
+  };
+
+  /// 进程内唯一的池（线程本地缓存需要一个固定的归属对象）
+  static TensorBufferPool &instance() {
+    static TensorBufferPool pool;
+    return pool;
+  }
+
+  /// 从池中取一个至少 size 字节的缓冲区，离开作用域自动归还
+  UniqueTensorBuffer acquire_unique(size_t size) {
+    SafeTensorBuffer *buffer = acquire_raw(size);
+    return UniqueTensorBuffer(buffer, deleter_for(buffer));
+  }
+
+  /// shared_ptr 版本：最后一个引用释放时归还
+  TensorBufferPtr acquire_shared(size_t size) {
+    SafeTensorBuffer *buffer = acquire_raw(size);
+    return TensorBufferPtr(buffer, deleter_for(buffer));
+  }
+
+  /// 汇总各线程计数；线程本地计数只由所属线程写，这里只读
+  Stats stats() const {
+    Counters total;
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex_);
+      total = retired_;
+      for (const ThreadCache *cache : caches_) {
+        total += cache->counters.snapshot();
+      }
+      total -= baseline_;
+    }
+    Stats s;
+    s.acquires = total.acquires;
+    s.local_hits = total.local_hits;
+    s.depot_hits = total.depot_hits;
+    s.heap_allocations = total.heap_allocations;
+    s.bypass = total.bypass;
+    s.releases = total.releases;
+    {
+      std::lock_guard<std::mutex> lock(depot_mutex_);
+      s.retained_bytes = total.local_bytes + depot_bytes_;
+    }
+    s.elapsed_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() -
+                            stats_start_.load(std::memory_order_relaxed))
+                            .count();
+    return s;
+  }
+
+  /// 清零计数：记下当前总和作为基线，不去写其他线程的计数
+  /// （retained_bytes 是状态而非计数，保持不变）
+  void reset_stats() {
+    {
+      std::lock_guard<std::mutex> lock(registry_mutex_);
+      Counters total = retired_;
+      for (const ThreadCache *cache : caches_) {
+        total += cache->counters.snapshot();
+      }
+      total.local_bytes = 0;
+      baseline_ = total;
+    }
+    stats_start_ = std::chrono::steady_clock::now();
+  }
+
+  void print_stats(std::ostream &os) const {
+    Stats s = stats();
+    const std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1);
+    os << "[TensorBufferPool] 请求 " << s.acquires << " 次 ("
+       << s.acquire_rate() << " 次/秒), 命中率 " << s.hit_rate() * 100.0
+       << "% (本地 " << s.local_hits << ", 仓库 " << s.depot_hits
+       << "), 堆分配 " << s.heap_allocations << " 次 ("
+       << s.heap_allocation_rate() << " 次/秒), 不入池 " << s.bypass
+       << " 次, 闲置 " << static_cast<double>(s.retained_bytes) / (1 << 20)
+       << " MiB" << std::endl;
+    os.unsetf(std::ios::fixed);
+    os.precision(precision);
+  }
+
+  /// 释放当前线程的本地缓存和仓库中所有闲置缓冲区
+  /// （其他线程的本地缓存在线程退出时归还仓库）
+  void trim() {
+    if (ThreadCache *cache = local_cache()) {
+      for (size_t cls = 0; cls < kNumClasses; ++cls) {
+        FreeList &list = cache->lists[cls];
+        for (SafeTensorBuffer *buffer : list) {
+          cache->counters.sub(cache->counters.local_bytes, buffer->size());
+          delete buffer;
+        }
+        list.clear();
+      }
+    }
+    release_depot();
+  }
+
+  /// 级别编号：不小于 size 的最小 2 的幂，下限 256B；超过上限返回 kNumClasses
+  static size_t size_class(size_t size) {
+    if (size <= (size_t{1} << kMinClassShift)) {
+      return 0;
+    }
+    size_t shift = 64 - static_cast<size_t>(__builtin_clzll(size - 1));
+    return shift > kMaxClassShift ? kNumClasses : shift - kMinClassShift;
+  }
+
+  static size_t class_bytes(size_t cls) {
+    return size_t{1} << (cls + kMinClassShift);
+  }
+
+  TensorBufferPool(const TensorBufferPool &) = delete;
+  TensorBufferPool &operator=(const TensorBufferPool &) = delete;
+
+private:
+  using FreeList = std::vector<SafeTensorBuffer *>;
+
+  /// 一组计数的普通值（快照、基线、已退出线程的累计）
+  struct Counters {
+    uint64_t acquires = 0;
+    uint64_t local_hits = 0;
+    uint64_t depot_hits = 0;
+    uint64_t heap_allocations = 0;
+    uint64_t bypass = 0;
+    uint64_t releases = 0;
+    uint64_t local_bytes = 0; ///< 本地链表中闲置的字节数（状态）
+
+    Counters &operator+=(const Counters &o) {
+      acquires += o.acquires;
+      local_hits += o.local_hits;
+      depot_hits += o.depot_hits;
+      heap_allocations += o.heap_allocations;
+      bypass += o.bypass;
+      releases += o.releases;
+      local_bytes += o.local_bytes;
+      return *this;
+    }
+    Counters &operator-=(const Counters &o) {
+      acquires -= o.acquires;
+      local_hits -= o.local_hits;
+      depot_hits -= o.depot_hits;
+      heap_allocations -= o.heap_allocations;
+      bypass -= o.bypass;
+      releases -= o.releases;
+      local_bytes -= o.local_bytes;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief 线程本地计数
+   *
+   * 只有所属线程写，stats() 从其他线程读：用 relaxed load + store 代替
+   * fetch_add，热路径上没有带 lock 前缀的读-改-写，也不和其他线程争缓存行。
+   */
+  struct LocalCounters {
+    std::atomic<uint64_t> acquires{0};
+    std::atomic<uint64_t> local_hits{0};
+    std::atomic<uint64_t> depot_hits{0};
+    std::atomic<uint64_t> heap_allocations{0};
+    std::atomic<uint64_t> bypass{0};
+    std::atomic<uint64_t> releases{0};
+    std::atomic<uint64_t> local_bytes{0};
+
+    static void add(std::atomic<uint64_t> &c, uint64_t n = 1) {
+      c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    static void sub(std::atomic<uint64_t> &c, uint64_t n) {
+      c.store(c.load(std::memory_order_relaxed) - n, std::memory_order_relaxed);
+    }
+
+    Counters snapshot() const {
+      Counters c;
+      c.acquires = acquires.load(std::memory_order_relaxed);
+      c.local_hits = local_hits.load(std::memory_order_relaxed);
+      c.depot_hits = depot_hits.load(std::memory_order_relaxed);
+      c.heap_allocations = heap_allocations.load(std::memory_order_relaxed);
+      c.bypass = bypass.load(std::memory_order_relaxed);
+      c.releases = releases.load(std::memory_order_relaxed);
+      c.local_bytes = local_bytes.load(std::memory_order_relaxed);
+      return c;
+    }
+  };
+
+  /// 线程本地缓存：构造时登记到池，线程退出时把剩余缓冲区还给仓库、计数并入池
+  struct ThreadCache {
+    std::array<FreeList, kNumClasses> lists;
+    LocalCounters counters;
+    TensorBufferPool &pool;
+
+    explicit ThreadCache(TensorBufferPool &owner) : pool(owner) {
+      std::lock_guard<std::mutex> lock(pool.registry_mutex_);
+      pool.caches_.push_back(this);
+    }
+
+    ~ThreadCache() {
+      cache_destroyed_ = true;
+      if (pool_destroyed_.load(std::memory_order_acquire)) {
+        // 池已析构（线程晚于静态对象退出）：缓存的缓冲区只能直接释放
+        for (FreeList &list : lists) {
+          for (SafeTensorBuffer *buffer : list) {
+            delete buffer;
+          }
+        }
+        return;
+      }
+      for (size_t cls = 0; cls < kNumClasses; ++cls) {
+        pool.flush_to_depot(*this, cls, lists[cls].size());
+      }
+      std::lock_guard<std::mutex> lock(pool.registry_mutex_);
+      pool.retired_ += counters.snapshot();
+      pool.caches_.erase(
+          std::find(pool.caches_.begin(), pool.caches_.end(), this));
+    }
+  };
+
+  TensorBufferPool() : stats_start_(std::chrono::steady_clock::now()) {}
+
+  ~TensorBufferPool() {
+    pool_destroyed_.store(true, std::memory_order_release);
+    release_depot();
+  }
+
+  /// 当前线程的缓存；线程本地缓存已析构（线程退出阶段）时返回 nullptr
+  ThreadCache *local_cache() {
+    if (cache_destroyed_) {
+      return nullptr;
+    }
+    static thread_local ThreadCache cache(*this);
+    return &cache;
+  }
+
+  static size_t local_limit(size_t cls) {
+    size_t n = kLocalCacheBytes / class_bytes(cls);
+    return n < 1 ? 1 : (n > kLocalCacheCount ? kLocalCacheCount : n);
+  }
+
+  static void recycle(SafeTensorBuffer *buffer) {
+    if (pool_destroyed_.load(std::memory_order_acquire)) {
+      delete buffer;
+      return;
+    }
+    instance().release_raw(buffer);
+  }
+
+  static void destroy(SafeTensorBuffer *buffer) { delete buffer; }
+
+  /// 池中对象归还到池；不入池的对象直接释放
+  TensorBufferDeleter deleter_for(const SafeTensorBuffer *buffer) const {
+    bool pooled = buffer->alignment() == SafeTensorBuffer::kMinAlignment &&
+                  size_class(buffer->size()) < kNumClasses &&
+                  class_bytes(size_class(buffer->size())) == buffer->size();
+    return TensorBufferDeleter{pooled ? &TensorBufferPool::recycle
+                                      : &TensorBufferPool::destroy};
+  }
+
+  SafeTensorBuffer *acquire_raw(size_t size) {
+    size_t cls = size_class(size);
+    ThreadCache *cache = local_cache();
+    if (cache == nullptr) {
+      return new SafeTensorBuffer(cls >= kNumClasses ? size : class_bytes(cls));
+    }
+    LocalCounters &counters = cache->counters;
+    LocalCounters::add(counters.acquires);
+    if (cls >= kNumClasses) {
+      LocalCounters::add(counters.bypass);
+      return new SafeTensorBuffer(size);
+    }
+
+    FreeList &list = cache->lists[cls];
+    if (list.empty()) {
+      refill_from_depot(*cache, cls);
+    } else {
+      LocalCounters::add(counters.local_hits);
+    }
+    if (!list.empty()) {
+      SafeTensorBuffer *buffer = list.back();
+      list.pop_back();
+      LocalCounters::sub(counters.local_bytes, buffer->size());
+      return buffer;
+    }
+
+    LocalCounters::add(counters.heap_allocations);
+    return new SafeTensorBuffer(class_bytes(cls));
+  }
+
+  void release_raw(SafeTensorBuffer *buffer) {
+    ThreadCache *cache = local_cache();
+    if (cache == nullptr) {
+      delete buffer;
+      return;
+    }
+    LocalCounters &counters = cache->counters;
+    LocalCounters::add(counters.releases);
+    size_t cls = size_class(buffer->size());
+    FreeList &list = cache->lists[cls];
+    list.push_back(buffer);
+    LocalCounters::add(counters.local_bytes, buffer->size());
+    if (list.size() > local_limit(cls)) {
+      flush_to_depot(*cache, cls, list.size() / 2);
+    }
+    if (counters.local_bytes.load(std::memory_order_relaxed) >
+        kLocalCacheBytes) {
+      shrink_local(*cache);
+    }
+  }
+
+  /// 本地缓存总字节数超过 kLocalCacheBytes：从最大的级别开始整条还给仓库
+  void shrink_local(ThreadCache &cache) {
+    for (size_t cls = kNumClasses; cls-- > 0;) {
+      if (cache.counters.local_bytes.load(std::memory_order_relaxed) <=
+          kLocalCacheBytes) {
+        return;
+      }
+      flush_to_depot(cache, cls, cache.lists[cls].size());
+    }
+  }
+
+  /// 从仓库批量取（最多本地上限的一半），减少加锁次数
+  void refill_from_depot(ThreadCache &cache, size_t cls) {
+    FreeList &list = cache.lists[cls];
+    std::lock_guard<std::mutex> lock(depot_mutex_);
+    FreeList &depot = depot_[cls];
+    if (depot.empty()) {
+      return;
+    }
+    LocalCounters::add(cache.counters.depot_hits);
+    size_t batch = local_limit(cls) / 2;
+    batch = batch < 1 ? 1 : batch;
+    while (batch-- > 0 && !depot.empty()) {
+      size_t bytes = depot.back()->size();
+      depot_bytes_ -= bytes;
+      LocalCounters::add(cache.counters.local_bytes, bytes);
+      list.push_back(depot.back());
+      depot.pop_back();
+    }
+  }
+
+  /// 把本地链表末尾 count 个缓冲区移到仓库；仓库超过上限的部分直接释放
+  void flush_to_depot(ThreadCache &cache, size_t cls, size_t count) {
+    FreeList &list = cache.lists[cls];
+    FreeList victims;
+    {
+      std::lock_guard<std::mutex> lock(depot_mutex_);
+      for (size_t i = 0; i < count; ++i) {
+        SafeTensorBuffer *buffer = list.back();
+        list.pop_back();
+        LocalCounters::sub(cache.counters.local_bytes, buffer->size());
+        if (depot_bytes_ + buffer->size() > kMaxDepotBytes) {
+          victims.push_back(buffer);
+        } else {
+          depot_bytes_ += buffer->size();
+          depot_[cls].push_back(buffer);
+        }
+      }
+    }
+    for (SafeTensorBuffer *buffer : victims) {
+      delete buffer;
+    }
+  }
+
+  /// 释放仓库中所有闲置缓冲区
+  void release_depot() {
+    std::vector<SafeTensorBuffer *> victims;
+    {
+      std::lock_guard<std::mutex> lock(depot_mutex_);
+      for (auto &list : depot_) {
+        victims.insert(victims.end(), list.begin(), list.end());
+        list.clear();
+      }
+      depot_bytes_ = 0;
+    }
+    for (SafeTensorBuffer *buffer : victims) {
+      delete buffer;
+    }
+  }
+
+  // 析构标记：平凡类型，静态/线程本地对象析构之后仍可读取
+  static inline std::atomic<bool> pool_destroyed_{false};
+  static inline thread_local bool cache_destroyed_ = false;
+
+  // 统计：各线程的 LocalCounters 登记在 caches_ 中，读取时求和
+  mutable std::mutex registry_mutex_;
+  std::vector<ThreadCache *> caches_;
+  Counters retired_;  ///< 已退出线程的累计
+  Counters baseline_; ///< reset_stats() 时的总和
+  std::atomic<std::chrono::steady_clock::time_point> stats_start_;
+
+  // 共享仓库
+  mutable std::mutex depot_mutex_;
+  std::array<FreeList, kNumClasses> depot_;
+  size_t depot_bytes_ = 0;
+};
+
+/// 便捷函数：从全局池取 shared_ptr 缓冲区（对应 make_tensor_buffer）
+inline TensorBufferPtr make_pooled_tensor_buffer(size_t size) {
+  return TensorBufferPool::instance().acquire_shared(size);
+}
+
+#endif // TENSOR_BUFFER_POOL_HPP
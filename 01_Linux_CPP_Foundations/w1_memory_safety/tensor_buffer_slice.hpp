@@ -0,0 +1,116 @@
+/**
+ * @file tensor_buffer_slice.hpp
+ * @brief TensorBufferSlice - 共享父缓冲区所有权的子区间（零拷贝拆分 batch）
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef TENSOR_BUFFER_SLICE_HPP
+#define TENSOR_BUFFER_SLICE_HPP
+
+#include "safe_tensor_buffer.hpp"
+#include "tensor_view.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @class TensorBufferSlice
+ * @brief 父缓冲区 [offset, offset + length) 的句柄
+ *
+ * - 持有父缓冲区的 TensorBufferPtr：只要还有切片存活，父缓冲区就不会释放
+ *   （池中取出的缓冲区在最后一个切片释放时才归还到池）
+ * - 拷贝切片只增加引用计数，不拷贝数据；可以按值交给下游线程
+ * - 切片之间不做写冲突检查，写入各自区间由调用方保证
+ */
+class TensorBufferSlice {
+public:
+  TensorBufferSlice() : offset_(0), length_(0) {}
+
+  /**
+   * @throws std::invalid_argument parent 为空
+   * @throws std::out_of_range 区间超出父缓冲区
+   */
+  TensorBufferSlice(TensorBufferPtr parent, size_t offset, size_t length)
+      : parent_(std::move(parent)), offset_(offset), length_(length) {
+    if (!parent_ || !parent_->valid()) {
+      throw std::invalid_argument("TensorBufferSlice: parent is empty");
+    }
+    if (offset > parent_->size() || length > parent_->size() - offset) {
+      throw std::out_of_range("TensorBufferSlice: range exceeds parent");
+    }
+  }
+
+  uint8_t *data() const noexcept {
+    return parent_ ? parent_->data() + offset_ : nullptr;
+  }
+  size_t size() const noexcept { return length_; }
+  size_t offset() const noexcept { return offset_; }
+  bool valid() const noexcept { return parent_ != nullptr; }
+
+  /// 父缓冲区（引用计数 = 所有切片 + 其他持有者）
+  const TensorBufferPtr &parent() const noexcept { return parent_; }
+
+  /// 切片内的子切片（offset 相对本切片），共享同一个父缓冲区
+  TensorBufferSlice subslice(size_t offset, size_t length) const {
+    if (offset > length_ || length > length_ - offset) {
+      throw std::out_of_range("TensorBufferSlice: subslice out of range");
+    }
+    return TensorBufferSlice(parent_, offset_ + offset, length);
+  }
+
+  /**
+   * @brief 切片上的连续张量视图
+   * @throws std::invalid_argument 形状超出切片或起点未按 alignof(T) 对齐
+   */
+  template <typename T>
+  TensorView<T> view(std::initializer_list<size_t> shape) const {
+    uint8_t *base = data();
+    if (reinterpret_cast<uintptr_t>(base) % alignof(T) != 0) {
+      throw std::invalid_argument("TensorBufferSlice: misaligned view");
+    }
+    TensorView<T> view(reinterpret_cast<T *>(base), shape);
+    if (view.numel() * sizeof(T) > length_) {
+      throw std::invalid_argument("TensorBufferSlice: shape exceeds slice");
+    }
+    return view;
+  }
+
+  /// 放弃对父缓冲区的引用
+  void reset() noexcept {
+    parent_.reset();
+    offset_ = 0;
+    length_ = 0;
+  }
+
+private:
+  TensorBufferPtr parent_;
+  size_t offset_;
+  size_t length_;
+};
+
+/// 便捷函数：对应 make_tensor_buffer
+inline TensorBufferSlice make_slice(const TensorBufferPtr &parent,
+                                    size_t offset, size_t length) {
+  return TensorBufferSlice(parent, offset, length);
+}
+
+/**
+ * @brief 把 batch 缓冲区按固定步长切成 count 个槽位
+ * @param slot_bytes 每个槽位的字节数（例如一帧 NCHW 的大小）
+ * @throws std::out_of_range count * slot_bytes 超出父缓冲区
+ */
+inline std::vector<TensorBufferSlice>
+split_batch(const TensorBufferPtr &parent, size_t count, size_t slot_bytes) {
+  std::vector<TensorBufferSlice> slots;
+  slots.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    slots.emplace_back(parent, i * slot_bytes, slot_bytes);
+  }
+  return slots;
+}
+
+#endif // TENSOR_BUFFER_SLICE_HPP
@@ -0,0 +1,355 @@
+/**
+ * @file tensor_kernels.hpp
+ * @brief 张量缓冲区的向量化 fill / copy（AVX2 / AVX-512，运行时分派）
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef TENSOR_KERNELS_HPP
+#define TENSOR_KERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TENSOR_KERNELS_X86 1
+#else
+#define TENSOR_KERNELS_X86 0
+#endif
+
+/// 指令集级别（按能力递增）
+enum class SimdLevel { kScalar, kAvx2, kAvx512 };
+
+inline const char *simd_level_name(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::kScalar:
+    return "scalar";
+  case SimdLevel::kAvx2:
+    return "avx2";
+  case SimdLevel::kAvx512:
+    return "avx512";
+  }
+  return "?";
+}
+
+/// 当前 CPU 支持的最高级别（首次调用时检测并缓存）
+inline SimdLevel detect_simd_level() {
+  static const SimdLevel level = [] {
+#if TENSOR_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return SimdLevel::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::kAvx2;
+    }
+#endif
+    return SimdLevel::kScalar;
+  }();
+  return level;
+}
+
+/// 末级缓存大小；sysconf 拿不到时按 8 MiB 估计
+inline size_t llc_size() {
+  static const size_t size = [] {
+    long bytes = -1;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    return bytes > 0 ? static_cast<size_t>(bytes) : size_t{8} << 20;
+  }();
+  return size;
+}
+
+/**
+ * @brief 默认的非临时存储阈值：末级缓存大小，最多 32 MiB
+ *
+ * 末级缓存由所有核心（虚拟机里还有其他租户）共享，sysconf 报告的是整颗
+ * 芯片的容量；超过 32 MiB 的写入即使"装得下"也会挤掉其他数据。
+ */
+inline size_t default_nt_threshold() {
+  return std::min(llc_size(), size_t{32} << 20);
+}
+
+/// kernel 选项：默认值即自动选择
+struct TensorKernelOptions {
+  /// 目标不小于该值时使用非临时存储（绕过缓存）；0 表示 default_nt_threshold()
+  size_t nt_threshold = 0;
+  /// 不小于该值时多线程切分
+  size_t parallel_threshold = size_t{64} << 20;
+  /// 最多使用的线程数；0 表示 hardware_concurrency()
+  unsigned max_threads = 0;
+  /// 指令集上限（基准对比用）；实际级别取它与 CPU 能力的较小者
+  SimdLevel max_simd = SimdLevel::kAvx512;
+  /// 不使用非临时存储的字节填充/拷贝直接交给 memset/memcpy：
+  /// glibc 已按 CPU 选择 AVX/ERMS 实现，缓存内的小尺寸上更快
+  bool libc_below_nt = true;
+};
+
+// =============================================================================
+//                          各指令集的内层循环
+// =============================================================================
+// 约定：dst 64 字节对齐，bytes 是 64 的倍数；pattern 为 64 字节的重复单元
+
+#if TENSOR_KERNELS_X86
+
+__attribute__((target("avx2"))) inline void
+fill_blocks_avx2(uint8_t *dst, const uint8_t *pattern, size_t bytes, bool nt) {
+  const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern));
+  const __m256i hi =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pattern + 32));
+  auto *out = reinterpret_cast<__m256i *>(dst);
+  const size_t n = bytes / 32;
+  if (nt) {
+    for (size_t i = 0; i < n; i += 2) {
+      _mm256_stream_si256(out + i, lo);
+      _mm256_stream_si256(out + i + 1, hi);
+    }
+    _mm_sfence(); // 非临时存储是弱序的，返回前必须排空
+  } else {
+    for (size_t i = 0; i < n; i += 2) {
+      _mm256_store_si256(out + i, lo);
+      _mm256_store_si256(out + i + 1, hi);
+    }
+  }
+}
+
+__attribute__((target("avx2"))) inline void
+copy_blocks_avx2(uint8_t *dst, const uint8_t *src, size_t bytes, bool nt) {
+  auto *out = reinterpret_cast<__m256i *>(dst);
+  const auto *in = reinterpret_cast<const __m256i *>(src);
+  const size_t n = bytes / 32;
+  if (nt) {
+    for (size_t i = 0; i < n; i += 2) {
+      __m256i a = _mm256_loadu_si256(in + i);
+      __m256i b = _mm256_loadu_si256(in + i + 1);
+      _mm256_stream_si256(out + i, a);
+      _mm256_stream_si256(out + i + 1, b);
+    }
+    _mm_sfence();
+  } else {
+    for (size_t i = 0; i < n; i += 2) {
+      __m256i a = _mm256_loadu_si256(in + i);
+      __m256i b = _mm256_loadu_si256(in + i + 1);
+      _mm256_store_si256(out + i, a);
+      _mm256_store_si256(out + i + 1, b);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline void
+fill_blocks_avx512(uint8_t *dst, const uint8_t *pattern, size_t bytes, bool nt) {
+  const __m512i v = _mm512_loadu_si512(pattern);
+  auto *out = reinterpret_cast<__m512i *>(dst);
+  const size_t n = bytes / 64;
+  if (nt) {
+    for (size_t i = 0; i < n; ++i) {
+      _mm512_stream_si512(out + i, v);
+    }
+    _mm_sfence();
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      _mm512_store_si512(out + i, v);
+    }
+  }
+}
+
+__attribute__((target("avx512f"))) inline void
+copy_blocks_avx512(uint8_t *dst, const uint8_t *src, size_t bytes, bool nt) {
+  auto *out = reinterpret_cast<__m512i *>(dst);
+  const size_t n = bytes / 64;
+  if (nt) {
+    for (size_t i = 0; i < n; ++i) {
+      _mm512_stream_si512(out + i, _mm512_loadu_si512(src + i * 64));
+    }
+    _mm_sfence();
+  } else {
+    for (size_t i = 0; i < n; ++i) {
+      _mm512_store_si512(out + i, _mm512_loadu_si512(src + i * 64));
+    }
+  }
+}
+
+#endif // TENSOR_KERNELS_X86
+
+/// 标量回退：libc 的 memset/memcpy 本身已针对平台优化（如 aarch64）
+inline void fill_blocks_scalar(uint8_t *dst, const uint8_t *pattern,
+                               size_t bytes) {
+  for (size_t i = 0; i < bytes; i += 64) {
+    std::memcpy(dst + i, pattern, 64);
+  }
+}
+
+// =============================================================================
+//                          分派与多线程切分
+// =============================================================================
+
+inline SimdLevel effective_simd_level(const TensorKernelOptions &options) {
+  return std::min(detect_simd_level(), options.max_simd);
+}
+
+inline bool use_nt_stores(size_t bytes, const TensorKernelOptions &options) {
+  return bytes >= (options.nt_threshold != 0 ? options.nt_threshold
+                                             : default_nt_threshold());
+}
+
+/// 把 [0, bytes) 按 64 字节边界切成若干段，每段调用 fn(offset, length)
+template <typename Fn>
+void for_each_chunk(size_t bytes, const TensorKernelOptions &options, Fn fn) {
+  if (bytes < options.parallel_threshold) {
+    fn(size_t{0}, bytes);
+    return;
+  }
+  // hardware_concurrency() 每次都会读 /sys，只查询一次
+  static const unsigned hardware_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  unsigned threads =
+      options.max_threads != 0 ? options.max_threads : hardware_threads;
+  // 每段至少 16 MiB，线程创建的开销才能被摊薄
+  const size_t max_useful = std::max<size_t>(1, bytes / (size_t{16} << 20));
+  threads = static_cast<unsigned>(std::min<size_t>(threads, max_useful));
+  if (threads <= 1) {
+    fn(size_t{0}, bytes);
+    return;
+  }
+  const size_t chunk = (bytes / threads + 63) / 64 * 64;
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; ++t) {
+    const size_t begin = chunk * t;
+    if (begin < bytes) {
+      workers.emplace_back(fn, begin, std::min(chunk, bytes - begin));
+    }
+  }
+  fn(size_t{0}, std::min(chunk, bytes));
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief 用 64 字节的重复单元填满 [dst, dst + bytes)
+ * @param pattern 周期（元素大小）整除 64，且 dst 按周期对齐，
+ *        因此从任何对齐位置开始复制 pattern 都得到相同的字节序列
+ *
+ * 头部（到 64 字节边界）和尾部不足一块的部分用 memcpy 补齐。
+ */
+inline void fill_with_pattern(uint8_t *dst, const uint8_t (&pattern)[64],
+                              size_t bytes, const TensorKernelOptions &options) {
+  const size_t head = std::min(
+      bytes, (64 - reinterpret_cast<uintptr_t>(dst) % 64) % 64);
+  std::memcpy(dst, pattern, head);
+  uint8_t *body = dst + head;
+  const size_t body_bytes = (bytes - head) / 64 * 64;
+  std::memcpy(body + body_bytes, pattern, bytes - head - body_bytes);
+
+  const bool nt = use_nt_stores(bytes, options);
+  const SimdLevel level = effective_simd_level(options);
+  for_each_chunk(body_bytes, options, [&](size_t offset, size_t length) {
+    switch (level) {
+#if TENSOR_KERNELS_X86
+    case SimdLevel::kAvx512:
+      fill_blocks_avx512(body + offset, pattern, length, nt);
+      return;
+    case SimdLevel::kAvx2:
+      fill_blocks_avx2(body + offset, pattern, length, nt);
+      return;
+#endif
+    default:
+      if (std::memcmp(pattern, pattern + 1, 63) == 0) {
+        std::memset(body + offset, pattern[0], length);
+      } else {
+        fill_blocks_scalar(body + offset, pattern, length);
+      }
+      return;
+    }
+  });
+}
+
+// =============================================================================
+//                              公开接口
+// =============================================================================
+
+/// 按字节填充（memset 的替代）
+inline void tensor_fill_bytes(void *dst, uint8_t value, size_t bytes,
+                              const TensorKernelOptions &options = {}) {
+  if (options.libc_below_nt && !use_nt_stores(bytes, options) &&
+      bytes < options.parallel_threshold) {
+    std::memset(dst, value, bytes);
+    return;
+  }
+  uint8_t pattern[64];
+  std::memset(pattern, value, sizeof(pattern));
+  fill_with_pattern(static_cast<uint8_t *>(dst), pattern, bytes, options);
+}
+
+/**
+ * @brief 按元素填充，例如 tensor_fill(ptr, 1.0f, n)
+ * @note sizeof(T) 须整除 64；dst 必须按 sizeof(T) 对齐（不只是 alignof(T)，
+ *       例如 alignof 为 2 的 8 字节结构体），否则 64 字节块的起点落在元素中间。
+ *       未按 sizeof(T) 对齐时退化为逐元素 memcpy，结果正确但没有向量化
+ */
+template <typename T>
+void tensor_fill(T *dst, T value, size_t count,
+                 const TensorKernelOptions &options = {}) {
+  static_assert(std::is_trivially_copyable<T>::value && 64 % sizeof(T) == 0,
+                "tensor_fill: element size must divide 64");
+  if (reinterpret_cast<uintptr_t>(dst) % sizeof(T) != 0) {
+    for (size_t i = 0; i < count; ++i) {
+      std::memcpy(dst + i, &value, sizeof(T));
+    }
+    return;
+  }
+  // 64 字节边界与元素边界重合，重复单元从元素起点开始
+  uint8_t pattern[64];
+  for (size_t i = 0; i < 64; i += sizeof(T)) {
+    std::memcpy(pattern + i, &value, sizeof(T));
+  }
+  fill_with_pattern(reinterpret_cast<uint8_t *>(dst), pattern,
+                    count * sizeof(T), options);
+}
+
+/// 拷贝（memcpy 的替代），区间不能重叠
+inline void tensor_copy(void *dst, const void *src, size_t bytes,
+                        const TensorKernelOptions &options = {}) {
+  const bool nt = use_nt_stores(bytes, options);
+  if (options.libc_below_nt && !nt && bytes < options.parallel_threshold) {
+    std::memcpy(dst, src, bytes);
+    return;
+  }
+  auto *out = static_cast<uint8_t *>(dst);
+  const auto *in = static_cast<const uint8_t *>(src);
+  // 以目标地址对齐：存储（尤其是非临时存储）必须对齐，加载可以不对齐
+  const size_t head = std::min(
+      bytes, (64 - reinterpret_cast<uintptr_t>(out) % 64) % 64);
+  std::memcpy(out, in, head);
+  out += head;
+  in += head;
+  const size_t body_bytes = (bytes - head) / 64 * 64;
+  std::memcpy(out + body_bytes, in + body_bytes, bytes - head - body_bytes);
+
+  const SimdLevel level = effective_simd_level(options);
+  for_each_chunk(body_bytes, options, [&](size_t offset, size_t length) {
+    switch (level) {
+#if TENSOR_KERNELS_X86
+    case SimdLevel::kAvx512:
+      copy_blocks_avx512(out + offset, in + offset, length, nt);
+      return;
+    case SimdLevel::kAvx2:
+      copy_blocks_avx2(out + offset, in + offset, length, nt);
+      return;
+#endif
+    default:
+      std::memcpy(out + offset, in + offset, length);
+      return;
+    }
+  });
+}
+
+#endif // TENSOR_KERNELS_HPP
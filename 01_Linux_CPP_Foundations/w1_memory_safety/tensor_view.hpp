@@ -0,0 +1,273 @@
+/**
+ * @file tensor_view.hpp
+ * @brief TensorView<T> - SafeTensorBuffer 上带形状/步长的非拥有视图
+ * @note 详细知识点说明见 notes.md
+ */
+
+#ifndef TENSOR_VIEW_HPP
+#define TENSOR_VIEW_HPP
+
+#include "safe_tensor_buffer.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief 元素访问的越界检查：调试构建抛 std::out_of_range，NDEBUG 下完全消失
+ *
+ * 只用于热路径上的逐元素访问；slice / permute 等结构操作始终检查参数。
+ */
+#ifdef NDEBUG
+#define TENSOR_VIEW_CHECK(cond, msg) ((void)0)
+#else
+#define TENSOR_VIEW_CHECK(cond, msg)                                           \
+  ((cond) ? (void)0 : throw std::out_of_range(msg))
+#endif
+
+/// 元素类型
+enum class DType { kUInt8, kInt8, kInt16, kInt32, kInt64, kFloat32, kFloat64 };
+
+template <typename T> constexpr DType dtype_of() {
+  using U = std::remove_cv_t<T>;
+  static_assert(std::is_arithmetic<U>::value, "TensorView: unsupported dtype");
+  if constexpr (std::is_same<U, float>::value) {
+    return DType::kFloat32;
+  } else if constexpr (std::is_same<U, double>::value) {
+    return DType::kFloat64;
+  } else if constexpr (sizeof(U) == 1) {
+    return std::is_signed<U>::value ? DType::kInt8 : DType::kUInt8;
+  } else if constexpr (sizeof(U) == 2) {
+    return DType::kInt16;
+  } else if constexpr (sizeof(U) == 4) {
+    return DType::kInt32;
+  } else {
+    return DType::kInt64;
+  }
+}
+
+inline const char *dtype_name(DType dtype) {
+  switch (dtype) {
+  case DType::kUInt8:
+    return "uint8";
+  case DType::kInt8:
+    return "int8";
+  case DType::kInt16:
+    return "int16";
+  case DType::kInt32:
+    return "int32";
+  case DType::kInt64:
+    return "int64";
+  case DType::kFloat32:
+    return "float32";
+  case DType::kFloat64:
+    return "float64";
+  }
+  return "?";
+}
+
+/// 视图支持的最大维数（NCHW + 2 个额外维度）
+constexpr size_t kMaxTensorRank = 6;
+
+/**
+ * @class TensorView
+ * @brief 不拥有内存的张量视图：指针 + 形状 + 步长（单位：元素）
+ *
+ * - 所有权留在 SafeTensorBuffer，视图只是几十字节的值类型，按值传递
+ * - slice / select / transpose / permute 只改步长和起始指针，零拷贝
+ * - T 为 const 时是只读视图；TensorView<T> 可隐式转换为 TensorView<const T>
+ */
+template <typename T> class TensorView {
+public:
+  using Shape = std::array<size_t, kMaxTensorRank>;
+  using Strides = std::array<ptrdiff_t, kMaxTensorRank>;
+
+  TensorView() : data_(nullptr), rank_(0), shape_{}, strides_{} {}
+
+  /// 连续（行主序）视图
+  TensorView(T *data, std::initializer_list<size_t> shape)
+      : data_(data), rank_(checked_rank(shape.size())), shape_{}, strides_{} {
+    size_t i = 0;
+    for (size_t extent : shape) {
+      shape_[i++] = extent;
+    }
+    ptrdiff_t stride = 1;
+    for (size_t d = rank_; d-- > 0;) {
+      strides_[d] = stride;
+      stride *= static_cast<ptrdiff_t>(shape_[d]);
+    }
+  }
+
+  /// 任意步长视图
+  TensorView(T *data, size_t rank, const Shape &shape, const Strides &strides)
+      : data_(data), rank_(checked_rank(rank)), shape_(shape),
+        strides_(strides) {}
+
+  /// 可写视图转只读视图
+  template <typename U,
+            typename = std::enable_if_t<std::is_same<const U, T>::value &&
+                                        !std::is_same<U, T>::value>>
+  TensorView(const TensorView<U> &other)
+      : data_(other.data()), rank_(other.rank()), shape_(other.shape()),
+        strides_(other.strides()) {}
+
+  T *data() const noexcept { return data_; }
+  size_t rank() const noexcept { return rank_; }
+  const Shape &shape() const noexcept { return shape_; }
+  const Strides &strides() const noexcept { return strides_; }
+  size_t shape(size_t dim) const { return shape_[checked_dim(dim)]; }
+  ptrdiff_t stride(size_t dim) const { return strides_[checked_dim(dim)]; }
+  static constexpr DType dtype() { return dtype_of<T>(); }
+
+  /// 元素个数
+  size_t numel() const noexcept {
+    size_t n = 1;
+    for (size_t d = 0; d < rank_; ++d) {
+      n *= shape_[d];
+    }
+    return n;
+  }
+
+  /// 行主序连续（可以直接当一维数组交给 memcpy / 向量化 kernel）
+  bool is_contiguous() const noexcept {
+    ptrdiff_t expected = 1;
+    for (size_t d = rank_; d-- > 0;) {
+      if (shape_[d] != 1 && strides_[d] != expected) {
+        return false;
+      }
+      expected *= static_cast<ptrdiff_t>(shape_[d]);
+    }
+    return true;
+  }
+
+  /// 元素访问：view(n, c, h, w)；越界检查仅在调试构建中存在
+  template <typename... Index> T &operator()(Index... index) const {
+    static_assert(sizeof...(Index) <= kMaxTensorRank,
+                  "TensorView: too many indices");
+    TENSOR_VIEW_CHECK(sizeof...(Index) == rank_,
+                      "TensorView: index count does not match rank");
+    const size_t indices[] = {static_cast<size_t>(index)...};
+    ptrdiff_t offset = 0;
+    for (size_t d = 0; d < sizeof...(Index); ++d) {
+      TENSOR_VIEW_CHECK(indices[d] < shape_[d], "TensorView: index out of range");
+      offset += static_cast<ptrdiff_t>(indices[d]) * strides_[d];
+    }
+    return data_[offset];
+  }
+
+  /**
+   * @brief 沿 dim 取 [begin, end)，每 step 个取一个
+   * @throws std::out_of_range 范围非法
+   */
+  TensorView slice(size_t dim, size_t begin, size_t end, size_t step = 1) const {
+    checked_dim(dim);
+    if (begin > end || end > shape_[dim] || step == 0) {
+      throw std::out_of_range("TensorView: invalid slice");
+    }
+    TensorView out = *this;
+    out.data_ = data_ + static_cast<ptrdiff_t>(begin) * strides_[dim];
+    out.shape_[dim] = (end - begin + step - 1) / step;
+    out.strides_[dim] = strides_[dim] * static_cast<ptrdiff_t>(step);
+    return out;
+  }
+
+  /// 固定 dim 上的下标，去掉该维（例如从 NCHW 取出第 n 张图）
+  TensorView select(size_t dim, size_t index) const {
+    checked_dim(dim);
+    if (index >= shape_[dim]) {
+      throw std::out_of_range("TensorView: select index out of range");
+    }
+    TensorView out;
+    out.data_ = data_ + static_cast<ptrdiff_t>(index) * strides_[dim];
+    out.rank_ = rank_ - 1;
+    for (size_t d = 0, o = 0; d < rank_; ++d) {
+      if (d != dim) {
+        out.shape_[o] = shape_[d];
+        out.strides_[o] = strides_[d];
+        ++o;
+      }
+    }
+    return out;
+  }
+
+  /// 交换两个维度（二维时即转置）
+  TensorView transpose(size_t dim0, size_t dim1) const {
+    checked_dim(dim0);
+    checked_dim(dim1);
+    TensorView out = *this;
+    std::swap(out.shape_[dim0], out.shape_[dim1]);
+    std::swap(out.strides_[dim0], out.strides_[dim1]);
+    return out;
+  }
+
+  /// 维度重排：out.shape(i) == shape(order[i])，例如 NCHW -> NHWC 为 {0,2,3,1}
+  TensorView permute(std::initializer_list<size_t> order) const {
+    if (order.size() != rank_) {
+      throw std::invalid_argument("TensorView: permute order size != rank");
+    }
+    TensorView out = *this;
+    bool seen[kMaxTensorRank] = {};
+    size_t i = 0;
+    for (size_t d : order) {
+      if (d >= rank_ || seen[d]) {
+        throw std::invalid_argument("TensorView: invalid permutation");
+      }
+      seen[d] = true;
+      out.shape_[i] = shape_[d];
+      out.strides_[i] = strides_[d];
+      ++i;
+    }
+    return out;
+  }
+
+private:
+  static size_t checked_rank(size_t rank) {
+    if (rank > kMaxTensorRank) {
+      throw std::invalid_argument("TensorView: rank exceeds kMaxTensorRank");
+    }
+    return rank;
+  }
+
+  size_t checked_dim(size_t dim) const {
+    if (dim >= rank_) {
+      throw std::out_of_range("TensorView: dimension out of range");
+    }
+    return dim;
+  }
+
+  T *data_;
+  size_t rank_;
+  Shape shape_;
+  Strides strides_;
+};
+
+/**
+ * @brief 在 SafeTensorBuffer 上建立连续视图
+ * @throws std::invalid_argument 缓冲区容量不足
+ */
+template <typename T>
+TensorView<T> make_tensor_view(SafeTensorBuffer &buffer,
+                               std::initializer_list<size_t> shape) {
+  TensorView<T> view(reinterpret_cast<T *>(buffer.data()), shape);
+  if (view.numel() * sizeof(T) > buffer.size()) {
+    throw std::invalid_argument("make_tensor_view: buffer too small for shape");
+  }
+  return view;
+}
+
+/// 只读版本
+template <typename T>
+TensorView<const T> make_tensor_view(const SafeTensorBuffer &buffer,
+                                     std::initializer_list<size_t> shape) {
+  TensorView<const T> view(reinterpret_cast<const T *>(buffer.data()), shape);
+  if (view.numel() * sizeof(T) > buffer.size()) {
+    throw std::invalid_argument("make_tensor_view: buffer too small for shape");
+  }
+  return view;
+}
+
+#endif // TENSOR_VIEW_HPP
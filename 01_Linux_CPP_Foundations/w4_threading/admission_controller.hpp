@@ -0,0 +1,181 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：生产者准入控制 - 根据消费吞吐自适应调整采集帧率
+//
+// 知识点：
+// 1. 用出队计数的时间差估计服务速率 μ（EWMA 平滑），只统计队列非空的时段
+// 2. 比例控制：λ = μ̂ + (目标占用 - 当前占用) / T，把队列长度拉回目标值
+// 3. 两种执行方式：直接调整帧率，或固定采集帧率、按比例抽帧（decimation）；
+//    抽帧比例按实测的采集帧率计算，而不是标称帧率
+
+#ifndef W4_THREADING_ADMISSION_CONTROLLER_HPP_
+#define W4_THREADING_ADMISSION_CONTROLLER_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么要在生产端控制？
+// =============================================================================
+// 消费者跟不上时，阻塞队列会积压满 Capacity 帧，每一帧都要排很久的队，
+// 推理拿到的总是"过时"的画面。对实时视觉来说，少采几帧比处理旧帧更好。
+// 准入控制让队列稳定在一个较小的目标长度：
+//   - 队列长度 ≈ 目标值 → 消费者不会饿死，也不会积压
+//   - 排队延迟 ≈ 目标长度 / 服务速率（Little 定律）
+// =============================================================================
+
+enum class AdmissionMode {
+  kAdjustRate,  // 调整生产者帧率（改变帧间隔）
+  kDecimate,    // 采集帧率不变，按比例丢弃部分帧（摄像头无法改帧率时）
+};
+
+struct AdmissionConfig {
+  AdmissionMode mode = AdmissionMode::kAdjustRate;
+  double min_fps = 5.0;
+  double max_fps = 60.0;
+  double target_occupancy = 2.0;    // 目标队列长度（帧）
+  double horizon_s = 0.25;          // 占用偏差在多长时间内被消除
+  double ewma_alpha = 0.3;          // 服务速率平滑系数
+  std::chrono::milliseconds sample_period{50};  // 服务速率采样窗口
+};
+
+// 有效帧率随时间的记录（用于报告）
+struct RateSample {
+  double time_s;        // 自控制器启动以来的秒数
+  double admitted_fps;  // 控制器给出的准入帧率
+  double service_fps;   // 估计的服务速率
+  double capture_fps;   // 实测的采集帧率（Update 调用频率）
+  size_t occupancy;     // 采样时的队列长度
+};
+
+// =============================================================================
+// AdmissionController 类
+// =============================================================================
+// 用法（每帧调用一次，单线程使用，由生产者线程持有）：
+//   controller.Update(now, buffer.Size(), buffer.GetPoppedCount());
+//   kAdjustRate: 帧间隔 = 1 / controller.AdmittedFps()
+//   kDecimate:   if (!controller.Admit()) 丢弃本帧
+//
+// 服务速率只在队列非空时采样：队列空着说明消费者在等帧，这段时间的出队速率
+// 只是到达速率，用它当 μ̂ 会让准入帧率一路降到 min_fps（生产者越慢、
+// 测得的 μ̂ 越低）。整个采样窗口都没有积压时，出队速率只作为 μ̂ 的下界。
+// =============================================================================
+class AdmissionController {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit AdmissionController(const AdmissionConfig& config)
+      : config_(config), admitted_fps_(config.max_fps) {}
+
+  void Reset(Clock::time_point now, uint64_t popped_total) {
+    start_ = now;
+    last_sample_ = now;
+    last_popped_ = popped_total;
+    last_update_ = now;
+    last_update_popped_ = popped_total;
+    last_occupancy_ = 0;
+    busy_time_ = Clock::duration::zero();
+    busy_pops_ = 0;
+    captures_ = 0;
+    service_fps_ = 0.0;
+    capture_fps_ = 0.0;
+    admitted_fps_ = config_.max_fps;
+    credit_ = 0.0;
+    history_.clear();
+    started_ = true;
+  }
+
+  // 根据最新的队列长度和累计出队数更新准入帧率（每采集一帧调用一次）
+  void Update(Clock::time_point now, size_t occupancy, uint64_t popped_total) {
+    if (!started_) Reset(now, popped_total);
+
+    // 相邻两次调用之间队列始终有帧 → 消费者一直在忙，计入服务时间
+    if (last_occupancy_ > 0 && occupancy > 0) {
+      busy_time_ += now - last_update_;
+      busy_pops_ += popped_total - last_update_popped_;
+    }
+    last_update_ = now;
+    last_update_popped_ = popped_total;
+    last_occupancy_ = occupancy;
+    ++captures_;
+
+    auto window = now - last_sample_;
+    if (window < config_.sample_period) return;
+
+    double window_s = std::chrono::duration<double>(window).count();
+    capture_fps_ = static_cast<double>(captures_) / window_s;
+    if (busy_time_ * 2 >= window) {
+      double measured = static_cast<double>(busy_pops_) /
+                        std::chrono::duration<double>(busy_time_).count();
+      service_fps_ = service_fps_ == 0.0
+                         ? measured
+                         : config_.ewma_alpha * measured +
+                               (1.0 - config_.ewma_alpha) * service_fps_;
+    } else {
+      // 消费者大部分时间在等帧：出队速率只是 μ 的下界
+      double lower_bound =
+          static_cast<double>(popped_total - last_popped_) / window_s;
+      service_fps_ = std::max(service_fps_, lower_bound);
+    }
+    last_sample_ = now;
+    last_popped_ = popped_total;
+    busy_time_ = Clock::duration::zero();
+    busy_pops_ = 0;
+    captures_ = 0;
+
+    // 前馈（服务速率）+ 比例反馈（占用偏差）
+    double error = config_.target_occupancy - static_cast<double>(occupancy);
+    double desired = service_fps_ + error / config_.horizon_s;
+    admitted_fps_ = std::clamp(desired, config_.min_fps, config_.max_fps);
+
+    history_.push_back(RateSample{
+        std::chrono::duration<double>(now - start_).count(), admitted_fps_,
+        service_fps_, capture_fps_, occupancy});
+  }
+
+  // 抽帧模式：本帧是否入队（在同一帧的 Update() 之后调用）
+  // 累积"信用"，每攒够 1 就放行一帧，长期比例 = admitted / 实测采集帧率；
+  // 第一个采样窗口之前或采集帧率低于 min_fps 时全部放行，
+  // 有效准入帧率因此不会低于 min(min_fps, 采集帧率)
+  bool Admit() {
+    if (capture_fps_ <= 0.0) return true;
+    credit_ += std::min(1.0, admitted_fps_ / capture_fps_);
+    if (credit_ >= 1.0) {
+      credit_ -= 1.0;
+      return true;
+    }
+    return false;
+  }
+
+  AdmissionMode Mode() const { return config_.mode; }
+  double AdmittedFps() const { return admitted_fps_; }
+  double ServiceFps() const { return service_fps_; }
+  double CaptureFps() const { return capture_fps_; }
+  const std::vector<RateSample>& History() const { return history_; }
+
+ private:
+  AdmissionConfig config_;
+  Clock::time_point start_{};
+  Clock::time_point last_sample_{};
+  uint64_t last_popped_ = 0;
+  Clock::time_point last_update_{};
+  uint64_t last_update_popped_ = 0;
+  size_t last_occupancy_ = 0;
+  Clock::duration busy_time_{};  // 本窗口内队列非空的时长
+  uint64_t busy_pops_ = 0;       // 本窗口内队列非空时段的出队数
+  uint64_t captures_ = 0;        // 本窗口内的 Update 次数（采集帧数）
+  double service_fps_ = 0.0;
+  double capture_fps_ = 0.0;
+  double admitted_fps_;
+  double credit_ = 0.0;
+  bool started_ = false;
+  std::vector<RateSample> history_;
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_ADMISSION_CONTROLLER_HPP_
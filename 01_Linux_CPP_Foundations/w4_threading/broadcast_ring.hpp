@@ -0,0 +1,338 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：广播环形缓冲区 - 一帧同时交给多个订阅者（检测 / 录像 / 缩略图）
+//
+// 知识点：
+// 1. 每个订阅者有独立的读游标，帧只存一份，订阅者拿到的是只读引用
+// 2. 槽位引用计数：所有订阅者都释放后才回收
+// 3. 慢订阅者处理：标记为 lagging 并跳到最新帧，避免拖住整条流水线
+
+#ifndef W4_THREADING_BROADCAST_RING_HPP_
+#define W4_THREADING_BROADCAST_RING_HPP_
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace w4 {
+
+// =============================================================================
+// 与 ThreadSafeRingBuffer 的区别
+// =============================================================================
+// ThreadSafeRingBuffer::Pop 把元素"移走"，一帧只能交给一个消费者。
+// 广播场景下每一帧要交给所有订阅者：
+//
+//   seq:      head_seq_                          tail_seq_
+//               ▼                                   ▼
+//   slots:  [ f5 | f6 | f7 | f8 |    |    |    |    ]
+//   cursor:   ▲ recorder      ▲ detector    ▲ thumbnailer
+//
+// 每个槽记录两个计数：
+//   unread  - 还没读到这一帧的订阅者数
+//   holders - 已读出、FrameRef 尚未析构的订阅者数
+// 两者都归零的最旧槽才会被回收，head_seq_ 前进。
+//
+// 帧对象通过 unique_ptr 存放在槽中（分配一次、反复复用），地址稳定：
+// kSkipLagging 模式下，若最旧的帧只剩慢订阅者还在处理，
+// 可以把帧对象"摘下"交给该订阅者单独持有，槽位立即回收，像素不做拷贝。
+// =============================================================================
+
+// 队列满（最旧的帧仍有订阅者未释放）时发布者的行为
+enum class BroadcastOverflow {
+  kBlock,        // 等待所有订阅者释放（最慢的订阅者决定整体速度）
+  kSkipLagging,  // 等待 lag_timeout 后，把还没读到最旧帧的订阅者标记为 lagging，
+                 // 让其跳到最新帧；正在处理中的帧被摘下单独保留到其释放
+};
+
+template <typename T, size_t Capacity>
+class BroadcastRing {
+ public:
+  using SubscriberId = size_t;
+
+  // ---------------------------------------------------------------------------
+  // FrameRef - 订阅者持有的只读引用（RAII）
+  // ---------------------------------------------------------------------------
+  // 指向槽中唯一的一份数据，不做任何拷贝；析构时释放该订阅者对槽的占用
+  class FrameRef {
+   public:
+    FrameRef(FrameRef&& other) noexcept
+        : ring_(std::exchange(other.ring_, nullptr)),
+          seq_(other.seq_),
+          item_(other.item_) {}
+    FrameRef& operator=(FrameRef&&) = delete;
+    FrameRef(const FrameRef&) = delete;
+    FrameRef& operator=(const FrameRef&) = delete;
+
+    ~FrameRef() {
+      if (ring_ != nullptr) ring_->Release(seq_);
+    }
+
+    const T& operator*() const { return *item_; }
+    const T* operator->() const { return item_; }
+    uint64_t Sequence() const { return seq_; }
+
+   private:
+    friend class BroadcastRing;
+    FrameRef(BroadcastRing* ring, uint64_t seq, const T* item)
+        : ring_(ring), seq_(seq), item_(item) {}
+
+    BroadcastRing* ring_;
+    uint64_t seq_;
+    const T* item_;
+  };
+
+  // 每个订阅者的统计
+  struct SubscriberStats {
+    uint64_t received = 0;    // 读到的帧数
+    uint64_t skipped = 0;     // 因 lagging 被跳过的帧数
+    uint64_t lag_events = 0;  // 被标记为 lagging 的次数
+  };
+
+  explicit BroadcastRing(
+      BroadcastOverflow overflow = BroadcastOverflow::kBlock,
+      std::chrono::milliseconds lag_timeout = std::chrono::milliseconds(20))
+      : overflow_(overflow),
+        lag_timeout_(lag_timeout),
+        head_seq_(0),
+        tail_seq_(0),
+        stopped_(false) {
+    static_assert(Capacity > 0, "Capacity must be greater than 0");
+  }
+
+  BroadcastRing(const BroadcastRing&) = delete;
+  BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+  // ---------------------------------------------------------------------------
+  // 订阅管理：新订阅者从下一帧开始接收
+  // ---------------------------------------------------------------------------
+  SubscriberId Subscribe() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscribers_.push_back(Subscriber{tail_seq_, true, SubscriberStats{}});
+    return subscribers_.size() - 1;
+  }
+
+  void Unsubscribe(SubscriberId id) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Subscriber& sub = subscribers_.at(id);
+      if (!sub.active) return;
+      // 放弃所有未读帧的占用
+      for (uint64_t seq = sub.cursor; seq < tail_seq_; ++seq) {
+        --SlotFor(seq).unread;
+      }
+      sub.cursor = tail_seq_;
+      sub.active = false;
+      Reclaim();
+    }
+    not_full_cv_.notify_all();
+    not_empty_cv_.notify_all();  // 唤醒可能阻塞在 Next() 上的该订阅者
+  }
+
+  // ---------------------------------------------------------------------------
+  // Publish - 发布一帧给所有当前订阅者
+  // ---------------------------------------------------------------------------
+  bool Publish(T item,
+               std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto has_space = [this]() {
+      return tail_seq_ - head_seq_ < Capacity || stopped_;
+    };
+
+    auto deadline = timeout == std::chrono::milliseconds::max()
+                        ? std::chrono::steady_clock::time_point::max()
+                        : std::chrono::steady_clock::now() + timeout;
+
+    while (!has_space()) {
+      if (overflow_ == BroadcastOverflow::kSkipLagging) {
+        auto lag_deadline = std::chrono::steady_clock::now() + lag_timeout_;
+        if (!not_full_cv_.wait_until(lock, std::min(lag_deadline, deadline),
+                                     has_space)) {
+          SkipLaggingSubscribers();
+        }
+      } else if (deadline == std::chrono::steady_clock::time_point::max()) {
+        not_full_cv_.wait(lock, has_space);
+      } else {
+        not_full_cv_.wait_until(lock, deadline, has_space);
+      }
+      if (!has_space() && std::chrono::steady_clock::now() >= deadline) {
+        return false;  // 超时
+      }
+    }
+
+    if (stopped_) return false;
+
+    Slot& slot = SlotFor(tail_seq_);
+    if (!slot.item) slot.item = std::make_unique<T>();
+    *slot.item = std::move(item);
+    slot.seq = tail_seq_;
+    slot.unread = ActiveSubscribers();
+    slot.holders = 0;
+    ++tail_seq_;
+    Reclaim();  // 没有订阅者时立即回收
+
+    lock.unlock();
+    not_empty_cv_.notify_all();  // 每个订阅者都需要看到这一帧
+    return true;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Next - 订阅者读取下一帧（返回只读引用，不拷贝）
+  // ---------------------------------------------------------------------------
+  std::optional<FrameRef> Next(
+      SubscriberId id,
+      std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Subscriber& sub = subscribers_.at(id);
+    auto predicate = [this, &sub]() {
+      return sub.cursor < tail_seq_ || stopped_ || !sub.active;
+    };
+
+    if (timeout == std::chrono::milliseconds::max()) {
+      not_empty_cv_.wait(lock, predicate);
+    } else if (!not_empty_cv_.wait_for(lock, timeout, predicate)) {
+      return std::nullopt;
+    }
+
+    // 停止后仍会读完剩余帧
+    if (!sub.active || sub.cursor >= tail_seq_) return std::nullopt;
+
+    uint64_t seq = sub.cursor++;
+    ++sub.stats.received;
+    Slot& slot = SlotFor(seq);
+    --slot.unread;
+    ++slot.holders;
+    return FrameRef(this, seq, slot.item.get());
+  }
+
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    not_full_cv_.notify_all();
+    not_empty_cv_.notify_all();
+  }
+
+  SubscriberStats GetStats(SubscriberId id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_.at(id).stats;
+  }
+
+  // 仍被至少一个订阅者占用的帧数（不含已摘下的帧）
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(tail_seq_ - head_seq_);
+  }
+
+  // 已从槽中摘下、仍由慢订阅者持有的帧数
+  size_t DetachedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return detached_.size();
+  }
+
+  static constexpr size_t GetCapacity() { return Capacity; }
+
+ private:
+  struct Slot {
+    std::unique_ptr<T> item;
+    uint64_t seq = 0;
+    uint32_t unread = 0;   // 尚未读到该帧的订阅者数
+    uint32_t holders = 0;  // 已读出但尚未释放的订阅者数
+  };
+
+  // 被摘下的帧：槽位已回收，帧对象由持有者独占，直到最后一个 FrameRef 析构
+  struct Detached {
+    std::unique_ptr<T> item;
+    uint32_t holders;
+  };
+
+  struct Subscriber {
+    uint64_t cursor;  // 下一个要读的序号
+    bool active;
+    SubscriberStats stats;
+  };
+
+  Slot& SlotFor(uint64_t seq) { return slots_[seq % Capacity]; }
+
+  uint32_t ActiveSubscribers() const {
+    uint32_t n = 0;
+    for (const Subscriber& sub : subscribers_) n += sub.active ? 1 : 0;
+    return n;
+  }
+
+  void Release(uint64_t seq) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      Slot& slot = SlotFor(seq);
+      if (seq >= head_seq_ && slot.seq == seq) {
+        --slot.holders;
+        Reclaim();
+      } else {
+        auto it = detached_.find(seq);
+        if (it != detached_.end() && --it->second.holders == 0) {
+          detached_.erase(it);
+        }
+      }
+    }
+    not_full_cv_.notify_one();
+  }
+
+  // 回收所有订阅者都已释放的最旧槽（需持锁）
+  void Reclaim() {
+    while (head_seq_ < tail_seq_) {
+      Slot& slot = SlotFor(head_seq_);
+      if (slot.unread != 0 || slot.holders != 0) break;
+      *slot.item = T{};  // 尽早释放帧占用的内存，保留对象本身供复用
+      ++head_seq_;
+    }
+  }
+
+  // 跳过慢订阅者（需持锁）：
+  // 1. 还没读到最旧帧的订阅者跳到最新帧，放弃中间所有帧的占用
+  // 2. 最旧帧若只剩持有者（正在处理），把帧对象摘下交给持有者，槽位回收
+  void SkipLaggingSubscribers() {
+    for (Subscriber& sub : subscribers_) {
+      if (!sub.active || sub.cursor != head_seq_) continue;
+      uint64_t skipped = tail_seq_ - sub.cursor;
+      for (uint64_t seq = sub.cursor; seq < tail_seq_; ++seq) {
+        --SlotFor(seq).unread;
+      }
+      sub.cursor = tail_seq_;
+      sub.stats.skipped += skipped;
+      ++sub.stats.lag_events;
+    }
+
+    Slot& head = SlotFor(head_seq_);
+    if (head_seq_ < tail_seq_ && head.unread == 0 && head.holders > 0) {
+      detached_.emplace(head_seq_, Detached{std::move(head.item), head.holders});
+      head.holders = 0;
+      ++head_seq_;
+    }
+    Reclaim();
+  }
+
+  BroadcastOverflow overflow_;
+  std::chrono::milliseconds lag_timeout_;
+  std::array<Slot, Capacity> slots_;
+  std::deque<Subscriber> subscribers_;  // deque：新增订阅者不会使已有引用失效
+  uint64_t head_seq_;  // 最旧的未回收帧
+  uint64_t tail_seq_;  // 下一个要发布的序号
+  std::map<uint64_t, Detached> detached_;
+  bool stopped_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable not_full_cv_;
+  std::condition_variable not_empty_cv_;
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_BROADCAST_RING_HPP_
@@ -0,0 +1,227 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：队列容量自动调优 - 用实测的到达率和处理时间分布推荐最小容量
+//
+// 知识点：
+// 1. Little 定律 L = λW：目标延迟 W 下系统里最多容纳 λW 帧，容量再大只会增加延迟
+// 2. 利用率 ρ = λ·E[S] / c ≥ 1 时任何容量都救不了，只能加消费者或降帧率
+// 3. 在 ρ < 1 时用虚拟时钟仿真（经验到达间隔 + 经验处理时间分布）
+//    从小到大搜索满足目标的最小容量
+// 4. 数据来源：飞行记录仪的 captured / process-begin / process-end 事件
+
+#ifndef W4_THREADING_CAPACITY_TUNER_HPP_
+#define W4_THREADING_CAPACITY_TUNER_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flight_recorder.hpp"
+#include "pipeline_sim.hpp"
+
+namespace w4 {
+
+// =============================================================================
+// 为什么容量不能靠猜？
+// =============================================================================
+// 图像队列的每个槽位是一整帧（1080p RGB ≈ 6MB）：
+//   - 太小：突发到达或处理时间长尾时丢帧
+//   - 太大：白占内存，而且排在队尾的帧要等很久，延迟目标被打破
+// 合适的容量取决于到达率 λ、处理时间分布 S 和消费者数 c，这些都可以测出来。
+// =============================================================================
+
+// 实测的负载画像
+struct WorkloadProfile {
+  double arrival_fps = 0.0;            // 到达率 λ（帧/秒）
+  std::vector<double> interarrival_ms;  // 相邻两次采集的间隔样本（按时间顺序）
+  std::vector<double> service_ms;      // 每帧处理时间样本
+  int num_consumers = 1;
+
+  // 实测到达序列中，任意长度为 window_ms 的时间窗内最多到达的帧数（突发）
+  size_t MaxArrivalsWithin(double window_ms) const {
+    if (interarrival_ms.empty()) return 0;
+    size_t best = 1;
+    double span = 0.0;  // 区间 [first, last) 内间隔之和
+    size_t first = 0;
+    for (size_t last = 0; last < interarrival_ms.size(); ++last) {
+      span += interarrival_ms[last];
+      while (span > window_ms) span -= interarrival_ms[first++];
+      // 间隔 first..last 两端共 (last + 2 - first) 次到达落在窗口内
+      best = std::max(best, last + 2 - first);
+    }
+    return best;
+  }
+
+  double MeanServiceMs() const {
+    if (service_ms.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : service_ms) sum += v;
+    return sum / static_cast<double>(service_ms.size());
+  }
+
+  // 服务能力上限 c / E[S]（帧/秒）
+  double CapacityFps() const {
+    double mean = MeanServiceMs();
+    return mean <= 0.0 ? 0.0 : 1000.0 * num_consumers / mean;
+  }
+
+  // ρ = λ / (c·μ)
+  double Utilization() const {
+    double cap = CapacityFps();
+    return cap <= 0.0 ? 0.0 : arrival_fps / cap;
+  }
+};
+
+// =============================================================================
+// 从飞行记录仪转储中提取负载画像
+// =============================================================================
+//   到达率：captured 事件的个数 / 时间跨度；到达间隔：相邻 captured 的时间差
+//   处理时间：同一帧 process-begin → process-end
+// =============================================================================
+inline WorkloadProfile ProfileFromFlightDump(const FlightDump& dump, int num_consumers) {
+  WorkloadProfile profile;
+  profile.num_consumers = num_consumers;
+
+  std::vector<uint64_t> captures;
+  std::map<uint64_t, uint64_t> begin_ns;
+  for (const FlightEvent& e : dump.events) {
+    switch (e.event) {
+      case FrameEvent::kCaptured:
+        captures.push_back(e.time_ns);
+        break;
+      case FrameEvent::kProcessBegin:
+        begin_ns[e.frame_id] = e.time_ns;
+        break;
+      case FrameEvent::kProcessEnd: {
+        auto it = begin_ns.find(e.frame_id);
+        if (it != begin_ns.end() && e.time_ns >= it->second) {
+          profile.service_ms.push_back(static_cast<double>(e.time_ns - it->second) / 1e6);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  std::sort(captures.begin(), captures.end());
+  if (captures.size() >= 2 && captures.back() > captures.front()) {
+    profile.arrival_fps = static_cast<double>(captures.size() - 1) * 1e9 /
+                          static_cast<double>(captures.back() - captures.front());
+    for (size_t i = 1; i < captures.size(); ++i) {
+      profile.interarrival_ms.push_back(
+          static_cast<double>(captures[i] - captures[i - 1]) / 1e6);
+    }
+  }
+  return profile;
+}
+
+// 调优目标
+struct TuningTarget {
+  double max_drop_rate = 0.01;   // 允许的丢帧率
+  double max_p99_ms = 100.0;     // 端到端 p99 延迟上限（采集 → 处理完成）
+  // 评估时的溢出策略：摄像头不会等人，满了只能丢新帧
+  OverflowPolicy policy = OverflowPolicy::kDropNewest;
+  size_t max_capacity = 256;     // 搜索上限
+  uint64_t sim_frames = 200000;  // 每个候选容量仿真的帧数
+  uint64_t seed = 42;
+};
+
+struct CapacityRecommendation {
+  bool feasible = false;
+  size_t capacity = 0;              // 推荐容量（不可行时为丢帧率最低的候选）
+  double utilization = 0.0;         // ρ
+  double littles_law_bound = 0.0;   // λ × W_target：平均意义下的在途帧数
+  size_t burst_bound = 0;           // 实测序列中 W_target 窗口内的最多到达数（搜索上界）
+  SimReport report;                 // 推荐容量的仿真结果
+  std::vector<std::pair<size_t, SimReport>> candidates;  // 搜索过程
+  std::string reason;
+};
+
+// =============================================================================
+// RecommendCapacity - 满足丢帧率和延迟目标的最小容量
+// =============================================================================
+// 1. ρ ≥ 1：直接判定不可行（队列只会越积越多）
+// 2. 搜索上界取实测到达序列里 W_target 时间窗内的最多到达数：
+//    比这更早到达的帧已经超出延迟目标，容量再大没有意义。
+//    平均值 λW_target（Little 定律）会低估突发，只作参考输出
+// 3. 从 1 开始逐个仿真（到达间隔和处理时间都按经验分布抽样），
+//    丢帧率随容量单调下降、延迟单调上升，第一个同时满足两个目标的就是最小容量
+// =============================================================================
+inline CapacityRecommendation RecommendCapacity(const WorkloadProfile& profile,
+                                                const TuningTarget& target) {
+  CapacityRecommendation rec;
+  rec.utilization = profile.Utilization();
+  rec.littles_law_bound = profile.arrival_fps * target.max_p99_ms / 1000.0;
+
+  if (profile.arrival_fps <= 0.0 || profile.service_ms.empty()) {
+    rec.reason = "no measurements";
+    return rec;
+  }
+  if (rec.utilization >= 1.0) {
+    std::ostringstream oss;
+    oss << "overloaded (rho=" << rec.utilization
+        << "): add consumers or lower the frame rate";
+    rec.reason = oss.str();
+    return rec;
+  }
+
+  SimConfig config;
+  config.num_consumers = profile.num_consumers;
+  config.target_fps = profile.arrival_fps;
+  config.total_frames = target.sim_frames;
+  config.policy = target.policy;
+  config.seed = target.seed;
+  config.service_samples.reserve(profile.service_ms.size());
+  for (double ms : profile.service_ms) {
+    config.service_samples.push_back(
+        static_cast<SimTime>(ms * static_cast<double>(kSimMillisecond)));
+  }
+  config.interarrival_samples.reserve(profile.interarrival_ms.size());
+  for (double ms : profile.interarrival_ms) {
+    config.interarrival_samples.push_back(
+        static_cast<SimTime>(ms * static_cast<double>(kSimMillisecond)));
+  }
+
+  // 没有间隔样本（手工构造的画像）时退回周期到达与 λW
+  rec.burst_bound =
+      profile.interarrival_ms.empty()
+          ? static_cast<size_t>(std::ceil(rec.littles_law_bound))
+          : profile.MaxArrivalsWithin(target.max_p99_ms);
+  size_t upper =
+      std::min(target.max_capacity, std::max<size_t>(1, rec.burst_bound));
+  double best_drop = 2.0;
+  for (size_t capacity = 1; capacity <= upper; ++capacity) {
+    config.capacity = capacity;
+    SimReport report = PipelineSimulator(config).Run();
+    rec.candidates.emplace_back(capacity, report);
+
+    if (report.DropRate() < best_drop) {
+      best_drop = report.DropRate();
+      rec.capacity = capacity;
+      rec.report = report;
+    }
+    if (report.DropRate() <= target.max_drop_rate &&
+        report.p99_e2e_ms <= target.max_p99_ms) {
+      rec.feasible = true;
+      rec.capacity = capacity;
+      rec.report = report;
+      rec.reason = "smallest capacity meeting both targets";
+      return rec;
+    }
+    // 延迟已超标：更大的容量只会更糟
+    if (report.p99_e2e_ms > target.max_p99_ms) break;
+  }
+
+  rec.reason = "drop-rate target unreachable within the latency budget";
+  return rec;
+}
+
+}  // namespace w4
+
+#endif  // W4_THREADING_CAPACITY_TUNER_HPP_
@@ -0,0 +1,232 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：运行时容量的线程安全环形缓冲区 - 容量取整到 2 的幂，用掩码代替取模
+//
+// 知识点：
+// 1. 容量在构造时确定（可来自配置文件或 capacity_tuner 的推荐），不必重新编译
+// 2. 2 的幂容量：index = counter & (capacity - 1)，热路径上没有除法
+// 3. 单调递增的 64 bit 读写计数：元素数 = tail - head，不需要单独的 count_
+// 4. 接口与 ThreadSafeRingBuffer 一致（Push / Pop / TryPop / Close / range-for）
+
+#ifndef W4_THREADING_DYNAMIC_RING_BUFFER_HPP_
+#define W4_THREADING_DYNAMIC_RING_BUFFER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么要掩码？
+// =============================================================================
+// ThreadSafeRingBuffer 的 tail_ = (tail_ + 1) % Capacity：
+//   - Capacity 是编译期常量，编译器能把 % 换成乘法或位与，但改深度就得重编
+//   - 改成运行时容量后，% 变成真正的 div 指令（几十个周期）
+// 把容量取整到 2 的幂，下标就是 counter & mask_，一条 and 指令。
+//
+// 为什么用 64 bit 单调计数？
+//   head_ / tail_ 只增不减，从不回绕到 0：
+//   - 元素数 = tail_ - head_，满 / 空判断不会混淆（无需额外的 count_ 或空一个槽位）
+//   - 按 60 FPS 计算，2^64 帧需要约 97 亿年才会溢出
+// =============================================================================
+
+// 不小于 n 的最小 2 的幂（n == 0 时返回 1）
+inline size_t RoundUpPowerOfTwo(size_t n) {
+  size_t capacity = 1;
+  while (capacity < n) capacity <<= 1;
+  return capacity;
+}
+
+// =============================================================================
+// DynamicRingBuffer 类
+// =============================================================================
+// 与 ThreadSafeRingBuffer 的差别：
+//   - 存储在堆上（std::unique_ptr<T[]>），容量 = RoundUpPowerOfTwo(min_capacity)
+//   - 不支持 eventfd 就绪通知和飞行记录仪（需要时用 ThreadSafeRingBuffer）
+// =============================================================================
+template <typename T, typename Mutex = std::mutex>
+class DynamicRingBuffer {
+ public:
+  // 上限避免左移溢出；实际上受内存限制远小于此
+  static constexpr size_t kMaxCapacity = size_t{1} << (sizeof(size_t) * 8 - 2);
+
+  explicit DynamicRingBuffer(size_t min_capacity)
+      : capacity_(CheckedCapacity(min_capacity)),
+        mask_(capacity_ - 1),
+        buffer_(std::make_unique<T[]>(capacity_)) {}
+
+  // 为锁命名（锁类型可由名字构造时可用，例如 ProfiledMutex）
+  template <typename M = Mutex,
+            typename = std::enable_if_t<std::is_constructible_v<M, const char*>>>
+  DynamicRingBuffer(size_t min_capacity, const char* lock_name)
+      : capacity_(CheckedCapacity(min_capacity)),
+        mask_(capacity_ - 1),
+        buffer_(std::make_unique<T[]>(capacity_)),
+        mutex_(lock_name) {}
+
+  DynamicRingBuffer(const DynamicRingBuffer&) = delete;
+  DynamicRingBuffer& operator=(const DynamicRingBuffer&) = delete;
+  DynamicRingBuffer(DynamicRingBuffer&&) = delete;
+  DynamicRingBuffer& operator=(DynamicRingBuffer&&) = delete;
+
+  // 阻塞式入队；超时或已关闭返回 false
+  bool Push(T item, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<Mutex> lock(mutex_);
+    auto predicate = [this]() { return tail_ - head_ < capacity_ || closed_; };
+
+    if (timeout == std::chrono::milliseconds::max()) {
+      not_full_cv_.wait(lock, predicate);
+    } else if (!not_full_cv_.wait_for(lock, timeout, predicate)) {
+      return false;
+    }
+    if (closed_) return false;
+
+    buffer_[tail_ & mask_] = std::move(item);
+    ++tail_;
+
+    lock.unlock();
+    not_empty_cv_.notify_one();
+    return true;
+  }
+
+  // 阻塞式出队；关闭且取空后返回 nullopt
+  std::optional<T> Pop(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<Mutex> lock(mutex_);
+    auto predicate = [this]() { return tail_ != head_ || closed_; };
+
+    if (timeout == std::chrono::milliseconds::max()) {
+      not_empty_cv_.wait(lock, predicate);
+    } else if (!not_empty_cv_.wait_for(lock, timeout, predicate)) {
+      return std::nullopt;
+    }
+    if (tail_ == head_) return std::nullopt;
+
+    T item = std::move(buffer_[head_ & mask_]);
+    ++head_;
+
+    lock.unlock();
+    not_full_cv_.notify_one();
+    return item;
+  }
+
+  std::optional<T> TryPop() {
+    std::unique_lock<Mutex> lock(mutex_);
+    if (tail_ == head_) return std::nullopt;
+    T item = std::move(buffer_[head_ & mask_]);
+    ++head_;
+    lock.unlock();
+    not_full_cv_.notify_one();
+    return item;
+  }
+
+  // Close 语义同 ThreadSafeRingBuffer::Close()
+  void Close() {
+    {
+      std::lock_guard<Mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_full_cv_.notify_all();
+    not_empty_cv_.notify_all();
+  }
+
+  void Stop() { Close(); }
+
+  // =========================================================================
+  // 迭代器 - for (auto& item : buffer) { ... }，Close() 且取空后退出
+  // =========================================================================
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    Iterator() = default;
+    explicit Iterator(DynamicRingBuffer* buffer) : buffer_(buffer) { Advance(); }
+
+    T& operator*() { return *current_; }
+    T* operator->() { return &*current_; }
+
+    Iterator& operator++() {
+      Advance();
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    void Advance() { current_ = buffer_->Pop(); }
+    bool AtEnd() const { return !current_.has_value(); }
+
+    DynamicRingBuffer* buffer_ = nullptr;
+    std::optional<T> current_;
+  };
+
+  Iterator begin() { return Iterator(this); }
+  Iterator end() { return Iterator(); }
+
+  size_t Size() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return static_cast<size_t>(tail_ - head_);
+  }
+
+  bool Empty() const { return Size() == 0; }
+  bool Full() const { return Size() == capacity_; }
+
+  // 单调计数本身就是累计出队 / 入队数
+  uint64_t GetPoppedCount() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return head_;
+  }
+
+  uint64_t GetPushedCount() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return tail_;
+  }
+
+  bool IsClosed() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return closed_;
+  }
+
+  // 实际容量（取整后），构造后不变，无需加锁
+  size_t GetCapacity() const { return capacity_; }
+
+ private:
+  using CondVar = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                     std::condition_variable,
+                                     std::condition_variable_any>;
+
+  static size_t CheckedCapacity(size_t min_capacity) {
+    if (min_capacity == 0 || min_capacity > kMaxCapacity) {
+      throw std::invalid_argument("DynamicRingBuffer: capacity out of range");
+    }
+    return RoundUpPowerOfTwo(min_capacity);
+  }
+
+  const size_t capacity_;          // 2 的幂
+  const uint64_t mask_;            // capacity_ - 1
+  std::unique_ptr<T[]> buffer_;
+  uint64_t head_ = 0;              // 累计出队数（读位置 = head_ & mask_）
+  uint64_t tail_ = 0;              // 累计入队数（写位置 = tail_ & mask_）
+  bool closed_ = false;
+
+  mutable Mutex mutex_;
+  CondVar not_full_cv_;
+  CondVar not_empty_cv_;
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_DYNAMIC_RING_BUFFER_HPP_
@@ -0,0 +1,515 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：飞行记录仪 - 常开的无锁二进制事件环，出问题时转储最近的历史
+//
+// 知识点：
+// 1. 固定大小的环形事件缓冲：写入只有一次 fetch_add + 几次 relaxed store
+// 2. 每条记录首尾各带一份序号（seqlock），两者一致才是完整记录
+// 3. 信号处理函数中只用 open / write / close（async-signal-safe）转储
+// 4. 离线解码：二进制文件 → 按帧聚合的时间线
+
+#ifndef W4_THREADING_FLIGHT_RECORDER_HPP_
+#define W4_THREADING_FLIGHT_RECORDER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么不用常规的 trace 导出？
+// =============================================================================
+// 完整 trace（JSON / perfetto）在现场常开太重；而延迟尖刺出现时，
+// 我们只需要"最近几秒发生了什么"。飞行记录仪的做法：
+//   - 一直往固定大小的环里写 40 字节的二进制事件，旧事件被覆盖
+//   - 平时从不读取；收到 SIGUSR1 或 SLO 违例时把整个环原样写到文件
+//   - 用 flight_recorder_decode 离线把文件解码成每一帧的时间线
+// 16384 条 × 40 字节 = 640KB，60 FPS 每帧约 6 个事件，约可保留 45 秒的历史。
+// =============================================================================
+
+enum class FrameEvent : uint8_t {
+  kCaptured = 1,  // 生产者生成了一帧
+  kDecimated,     // 准入控制丢弃
+  kEnqueued,      // Push 成功（aux = 入队后的队列长度）
+  kPushFailed,    // Push 失败（队列已关闭或超时）
+  kDequeued,      // Pop 取出（aux = 出队后的队列长度）
+  kProcessBegin,  // 消费者开始处理
+  kProcessEnd,    // 消费者处理完成（aux = 端到端延迟，微秒）
+  kSloViolation,  // 端到端延迟超过 SLO（aux = 延迟，微秒）
+};
+
+inline const char* FrameEventName(FrameEvent event) {
+  switch (event) {
+    case FrameEvent::kCaptured:
+      return "captured";
+    case FrameEvent::kDecimated:
+      return "decimated";
+    case FrameEvent::kEnqueued:
+      return "enqueued";
+    case FrameEvent::kPushFailed:
+      return "push-failed";
+    case FrameEvent::kDequeued:
+      return "dequeued";
+    case FrameEvent::kProcessBegin:
+      return "process-begin";
+    case FrameEvent::kProcessEnd:
+      return "process-end";
+    case FrameEvent::kSloViolation:
+      return "SLO-VIOLATION";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// 文件格式（小端，与内存布局相同）
+// =============================================================================
+//   FlightDumpHeader
+//   FlightRecordWords[capacity]    // 环的原始内容，按槽位顺序
+// =============================================================================
+struct FlightDumpHeader {
+  char magic[8];           // "W4FLTREC"
+  uint32_t version;
+  uint32_t record_bytes;   // sizeof(FlightRecordWords)
+  uint64_t capacity;       // 槽位数（2 的幂）
+  uint64_t next_seq;       // 转储时的写入序号（下一条记录将得到的序号）
+  uint64_t dump_time_ns;   // 转储时刻（steady_clock）
+  uint32_t reason;         // FlightDumpReason
+  uint32_t reserved;
+};
+
+enum class FlightDumpReason : uint32_t {
+  kManual = 0,
+  kSignal = 1,
+  kSloViolation = 2,
+};
+
+// 一条记录 = 5 个 64 位字（seqlock：序号在首尾各存一份）
+//   seq        : 写入序号 + 1，最先写入（0 表示从未写入）
+//   time_ns    : steady_clock 纳秒（与 SimulatedImage 的时间戳同源）
+//   frame_id   : 帧编号
+//   packed     : event(8) | aux(24) | tid(32)
+//   seq_end    : 与 seq 相同，最后写入（release）
+// 转储逐槽按与写入相反的顺序读取（先 seq_end、再内容、最后 seq）：
+// 若读取期间有写者覆盖该槽，读到的 seq 必然比 seq_end 新，两者不一致即为撕裂记录
+struct FlightRecordWords {
+  uint64_t seq;
+  uint64_t time_ns;
+  uint64_t frame_id;
+  uint64_t packed;
+  uint64_t seq_end;
+};
+
+// 解码后的事件
+struct FlightEvent {
+  uint64_t seq;
+  uint64_t time_ns;
+  uint64_t frame_id;
+  FrameEvent event;
+  uint32_t aux;
+  uint32_t tid;
+};
+
+// ThreadSanitizer 不理解独立的 atomic_thread_fence（并给出 -Wtsan 警告）：
+// TSAN 构建中改为对记录内容逐字使用 release 写 / acquire 读，顺序保证相同
+#if defined(__SANITIZE_THREAD__)
+#define W4_FLIGHT_RECORDER_NO_FENCE 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define W4_FLIGHT_RECORDER_NO_FENCE 1
+#endif
+#endif
+
+inline uint32_t FlightRecorderTid() {
+  thread_local uint32_t tid = static_cast<uint32_t>(syscall(SYS_gettid));
+  return tid;
+}
+
+// =============================================================================
+// FlightRecorder 类
+// =============================================================================
+// Record() 可被任意线程并发调用，无锁、不分配内存。
+// DumpToFile() 是 async-signal-safe 的，可以在信号处理函数里调用。
+// =============================================================================
+class FlightRecorder {
+ public:
+  static constexpr uint32_t kVersion = 2;  // v2：记录尾部增加 seq_end
+  static constexpr size_t kDefaultCapacity = 16384;
+  static constexpr uint64_t kMaxAux = (1u << 24) - 1;
+
+  explicit FlightRecorder(size_t capacity = kDefaultCapacity)
+      : capacity_(RoundUpPow2(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new Slot[capacity_]) {
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "flight records are loaded from a signal handler");
+  }
+
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  // =========================================================================
+  // Record - 热路径：一次 fetch_add + 5 次 store，不加锁
+  // =========================================================================
+  // 先写首部 seq，再写内容，最后 release 写入尾部 seq_end：
+  // 转储时 seq != seq_end、或序号不在快照范围内的记录被视为撕裂，解码器丢弃。
+  // =========================================================================
+  void Record(FrameEvent event, uint64_t frame_id, uint64_t aux = 0) {
+    uint64_t seq = next_seq_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[seq & mask_];
+    slot.seq.store(seq + 1, std::memory_order_relaxed);
+#ifndef W4_FLIGHT_RECORDER_NO_FENCE
+    std::atomic_thread_fence(std::memory_order_release);
+#endif
+    slot.time_ns.store(NowNs(), kBodyStoreOrder);
+    slot.frame_id.store(frame_id, kBodyStoreOrder);
+    slot.packed.store(static_cast<uint64_t>(event) |
+                          (std::min<uint64_t>(aux, kMaxAux) << 8) |
+                          (static_cast<uint64_t>(FlightRecorderTid()) << 32),
+                      kBodyStoreOrder);
+    slot.seq_end.store(seq + 1, std::memory_order_release);
+  }
+
+  // =========================================================================
+  // DumpToFile - 写出整个环（async-signal-safe：只用 open/write/close）
+  // =========================================================================
+  // 槽位经原子 load 拷贝到栈上的定长块（kDumpChunkRecords 条）再 write，
+  // 不直接 write 正在被 Record() 写入的内存；不分配堆内存。
+  // =========================================================================
+  bool DumpToFile(const char* path,
+                  FlightDumpReason reason = FlightDumpReason::kManual) const {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    FlightDumpHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "W4FLTREC", sizeof(header.magic));
+    header.version = kVersion;
+    header.record_bytes = sizeof(FlightRecordWords);
+    header.capacity = capacity_;
+    header.next_seq = next_seq_.load(std::memory_order_acquire);
+    header.dump_time_ns = NowNs();
+    header.reason = static_cast<uint32_t>(reason);
+
+    bool ok = WriteAll(fd, &header, sizeof(header));
+    FlightRecordWords chunk[kDumpChunkRecords];
+    for (size_t base = 0; ok && base < capacity_; base += kDumpChunkRecords) {
+      const size_t count = std::min(kDumpChunkRecords, capacity_ - base);
+      for (size_t i = 0; i < count; ++i) {
+        chunk[i] = LoadRecord(slots_[base + i]);
+      }
+      ok = WriteAll(fd, chunk, count * sizeof(FlightRecordWords));
+    }
+    close(fd);
+    dumps_.fetch_add(1, std::memory_order_relaxed);
+    return ok;
+  }
+
+  // =========================================================================
+  // SLO 违例触发转储（限频：两次转储至少间隔 min_interval）
+  // =========================================================================
+  // 返回是否真的写了文件；多个线程同时违例时只有一个执行转储。
+  // =========================================================================
+  bool DumpOnSloViolation(const char* path, uint64_t frame_id, uint64_t latency_us,
+                          std::chrono::milliseconds min_interval) {
+    Record(FrameEvent::kSloViolation, frame_id, latency_us);
+    uint64_t now = NowNs();
+    uint64_t last = last_slo_dump_ns_.load(std::memory_order_relaxed);
+    uint64_t interval = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(min_interval).count());
+    if (last != 0 && now - last < interval) return false;
+    if (!last_slo_dump_ns_.compare_exchange_strong(last, now,
+                                                   std::memory_order_relaxed)) {
+      return false;
+    }
+    return DumpToFile(path, FlightDumpReason::kSloViolation);
+  }
+
+  size_t Capacity() const { return capacity_; }
+  uint64_t RecordedCount() const { return next_seq_.load(std::memory_order_relaxed); }
+  uint64_t DumpCount() const { return dumps_.load(std::memory_order_relaxed); }
+
+  static uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+  }
+
+ private:
+  // 与 FlightRecordWords 布局一致，但每个字都是原子变量
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> time_ns{0};
+    std::atomic<uint64_t> frame_id{0};
+    std::atomic<uint64_t> packed{0};
+    std::atomic<uint64_t> seq_end{0};
+  };
+  static_assert(sizeof(Slot) == sizeof(FlightRecordWords),
+                "slot layout must match the dump format");
+
+  static constexpr size_t kDumpChunkRecords = 64;  // 64 × 40B = 2.5KB 栈空间
+#ifdef W4_FLIGHT_RECORDER_NO_FENCE
+  static constexpr std::memory_order kBodyStoreOrder = std::memory_order_release;
+  static constexpr std::memory_order kBodyLoadOrder = std::memory_order_acquire;
+#else
+  static constexpr std::memory_order kBodyStoreOrder = std::memory_order_relaxed;
+  static constexpr std::memory_order kBodyLoadOrder = std::memory_order_relaxed;
+#endif
+
+  // seqlock 读端：与写入顺序相反，seq_end（acquire）→ 内容 → 栅栏 → seq
+  static FlightRecordWords LoadRecord(const Slot& slot) {
+    FlightRecordWords w;
+    w.seq_end = slot.seq_end.load(std::memory_order_acquire);
+    w.time_ns = slot.time_ns.load(kBodyLoadOrder);
+    w.frame_id = slot.frame_id.load(kBodyLoadOrder);
+    w.packed = slot.packed.load(kBodyLoadOrder);
+#ifndef W4_FLIGHT_RECORDER_NO_FENCE
+    std::atomic_thread_fence(std::memory_order_acquire);
+#endif
+    w.seq = slot.seq.load(std::memory_order_relaxed);
+    return w;
+  }
+
+  static size_t RoundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+  }
+
+  static bool WriteAll(int fd, const void* data, size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+      ssize_t n = write(fd, p, bytes);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      p += n;
+      bytes -= static_cast<size_t>(n);
+    }
+    return true;
+  }
+
+  const size_t capacity_;
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> next_seq_{0};
+  std::atomic<uint64_t> last_slo_dump_ns_{0};
+  mutable std::atomic<uint64_t> dumps_{0};
+};
+
+// =============================================================================
+// SIGUSR1 转储
+// =============================================================================
+//   InstallFlightRecorderSignal(&recorder, "/tmp/frames.w4rec");
+//   $ kill -USR1 <pid>      # 现场触发
+//   $ ./flight_recorder_decode /tmp/frames.w4rec
+// 处理函数只读取预先保存的指针和路径，然后调用 DumpToFile。
+// =============================================================================
+namespace detail {
+
+inline std::atomic<const FlightRecorder*>& SignalRecorder() {
+  static std::atomic<const FlightRecorder*> recorder{nullptr};
+  return recorder;
+}
+
+inline char* SignalDumpPath() {
+  static char path[256] = {0};
+  return path;
+}
+
+inline void FlightRecorderSignalHandler(int) {
+  int saved_errno = errno;
+  const FlightRecorder* recorder = SignalRecorder().load(std::memory_order_acquire);
+  if (recorder != nullptr) {
+    recorder->DumpToFile(SignalDumpPath(), FlightDumpReason::kSignal);
+  }
+  errno = saved_errno;
+}
+
+}  // namespace detail
+
+// 传入 nullptr 取消（恢复默认处理）
+inline bool InstallFlightRecorderSignal(const FlightRecorder* recorder,
+                                        const char* path, int signo = SIGUSR1) {
+  struct sigaction action;
+  std::memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  if (recorder == nullptr) {
+    detail::SignalRecorder().store(nullptr, std::memory_order_release);
+    action.sa_handler = SIG_DFL;
+    return sigaction(signo, &action, nullptr) == 0;
+  }
+  if (std::strlen(path) >= 256) return false;
+  // 先写路径，再发布指针：处理函数看到指针时路径一定已就绪
+  std::strcpy(detail::SignalDumpPath(), path);
+  detail::SignalRecorder().store(recorder, std::memory_order_release);
+  action.sa_handler = detail::FlightRecorderSignalHandler;
+  return sigaction(signo, &action, nullptr) == 0;
+}
+
+// =============================================================================
+// 离线解码
+// =============================================================================
+struct FlightDump {
+  FlightDumpHeader header;
+  std::vector<FlightEvent> events;  // 按 seq 升序，只包含完整的记录
+  uint64_t torn = 0;  // 转储时正在写入、或在 next_seq 快照之后才写入的记录数
+};
+
+inline std::optional<FlightDump> LoadFlightDump(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return std::nullopt;
+
+  FlightDump dump;
+  in.read(reinterpret_cast<char*>(&dump.header), sizeof(dump.header));
+  if (!in || std::memcmp(dump.header.magic, "W4FLTREC", 8) != 0 ||
+      dump.header.version != FlightRecorder::kVersion ||
+      dump.header.record_bytes != sizeof(FlightRecordWords) ||
+      dump.header.capacity == 0) {
+    return std::nullopt;
+  }
+
+  const uint64_t capacity = dump.header.capacity;
+  const uint64_t next = dump.header.next_seq;
+  const uint64_t oldest = next > capacity ? next - capacity : 0;
+  std::vector<FlightRecordWords> words(capacity);
+  in.read(reinterpret_cast<char*>(words.data()),
+          static_cast<std::streamsize>(capacity * sizeof(FlightRecordWords)));
+  if (!in) return std::nullopt;
+
+  for (uint64_t slot = 0; slot < capacity; ++slot) {
+    const FlightRecordWords& w = words[slot];
+    if (w.seq == 0 && w.seq_end == 0) {
+      // 从未写入；但快照范围内的槽位应当写过 → 转储时首次写入尚未可见
+      if (slot < next) ++dump.torn;
+      continue;
+    }
+    // 首尾序号不一致：拷贝期间该槽被（重新）写入
+    if (w.seq != w.seq_end) {
+      ++dump.torn;
+      continue;
+    }
+    uint64_t seq = w.seq - 1;
+    // 序号必须落在本槽位，且在快照 [next - capacity, next) 之内
+    if ((seq & (capacity - 1)) != slot || seq < oldest || seq >= next) {
+      ++dump.torn;
+      continue;
+    }
+    dump.events.push_back(FlightEvent{
+        seq, w.time_ns, w.frame_id, static_cast<FrameEvent>(w.packed & 0xff),
+        static_cast<uint32_t>((w.packed >> 8) & FlightRecorder::kMaxAux),
+        static_cast<uint32_t>(w.packed >> 32)});
+  }
+  std::sort(dump.events.begin(), dump.events.end(),
+            [](const FlightEvent& a, const FlightEvent& b) { return a.seq < b.seq; });
+  return dump;
+}
+
+// 按帧编号聚合；同一帧的事件保持时间顺序
+inline std::map<uint64_t, std::vector<FlightEvent>> GroupByFrame(
+    const std::vector<FlightEvent>& events) {
+  std::map<uint64_t, std::vector<FlightEvent>> frames;
+  for (const FlightEvent& e : events) frames[e.frame_id].push_back(e);
+  for (auto& [id, list] : frames) {
+    std::stable_sort(list.begin(), list.end(),
+                     [](const FlightEvent& a, const FlightEvent& b) {
+                       return a.time_ns < b.time_ns;
+                     });
+  }
+  return frames;
+}
+
+inline const char* FlightDumpReasonName(uint32_t reason) {
+  switch (static_cast<FlightDumpReason>(reason)) {
+    case FlightDumpReason::kManual:
+      return "manual";
+    case FlightDumpReason::kSignal:
+      return "signal";
+    case FlightDumpReason::kSloViolation:
+      return "SLO violation";
+  }
+  return "unknown";
+}
+
+// 打印最近 last_frames 帧的时间线（以该帧第一个事件为零点）
+//   frame 17  span 25.31ms
+//       +0.000ms  captured       tid 1234
+//       +0.052ms  enqueued       tid 1234  q=3
+//      +12.310ms  dequeued       tid 1240  q=2
+//      +25.310ms  process-end    tid 1240  e2e=25.31ms
+inline void PrintFlightTimeline(std::ostream& os, const FlightDump& dump,
+                                size_t last_frames) {
+  auto frames = GroupByFrame(dump.events);
+  size_t skip = frames.size() > last_frames ? frames.size() - last_frames : 0;
+  for (const auto& [id, list] : frames) {
+    if (skip > 0) {
+      --skip;
+      continue;
+    }
+    const uint64_t t0 = list.front().time_ns;
+    os << "frame " << id << "  span " << std::fixed << std::setprecision(3)
+       << static_cast<double>(list.back().time_ns - t0) / 1e6 << "ms\n";
+    for (const FlightEvent& e : list) {
+      std::ostringstream offset;
+      offset << "+" << std::fixed << std::setprecision(3)
+             << static_cast<double>(e.time_ns - t0) / 1e6 << "ms";
+      os << std::right << std::setw(14) << offset.str() << "  " << std::left
+         << std::setw(14) << FrameEventName(e.event) << "tid " << e.tid;
+      switch (e.event) {
+        case FrameEvent::kEnqueued:
+        case FrameEvent::kDequeued:
+          os << "  q=" << e.aux;
+          break;
+        case FrameEvent::kProcessEnd:
+        case FrameEvent::kSloViolation:
+          os << "  e2e=" << static_cast<double>(e.aux) / 1e3 << "ms";
+          break;
+        default:
+          break;
+      }
+      os << std::right << "\n";
+    }
+    os.unsetf(std::ios::fixed);
+  }
+}
+
+// =============================================================================
+// 帧编号提取 - 让 ThreadSafeRingBuffer 在 Push/Pop 中记录事件
+// =============================================================================
+// T 有 GetId() 成员时记录真实帧号，否则记录 0（编译期选择）
+// =============================================================================
+template <typename T, typename = void>
+struct HasGetId : std::false_type {};
+template <typename T>
+struct HasGetId<T, std::void_t<decltype(std::declval<const T&>().GetId())>>
+    : std::true_type {};
+
+template <typename T>
+uint64_t FlightFrameId(const T& item) {
+  if constexpr (HasGetId<T>::value) {
+    return static_cast<uint64_t>(item.GetId());
+  } else {
+    (void)item;
+    return 0;
+  }
+}
+
+}  // namespace w4
+
+#endif  // W4_THREADING_FLIGHT_RECORDER_HPP_
@@ -0,0 +1,47 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：飞行记录仪离线解码工具 - 把转储文件还原成每帧的时间线
+//
+// 用法：
+//   ./flight_recorder_decode <dump-file> [最近帧数，默认 20]
+//
+// 知识点：
+// 1. 转储文件是环的原始内容，按序号排序即可恢复写入顺序
+// 2. 序号与槽位不符或为 0 的记录是转储时正在写入的"撕裂"记录，直接丢弃
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "flight_recorder.hpp"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <dump-file> [last-frames]\n";
+    return 2;
+  }
+  size_t last_frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+  auto dump = w4::LoadFlightDump(argv[1]);
+  if (!dump) {
+    std::cerr << "not a flight recorder dump: " << argv[1] << "\n";
+    return 1;
+  }
+
+  const w4::FlightDumpHeader& h = dump->header;
+  std::cout << "dump reason: " << w4::FlightDumpReasonName(h.reason)
+            << ", capacity: " << h.capacity << ", recorded: " << h.next_seq
+            << ", decoded: " << dump->events.size() << ", torn: " << dump->torn
+            << "\n";
+  if (!dump->events.empty()) {
+    double window_ms = static_cast<double>(dump->events.back().time_ns -
+                                           dump->events.front().time_ns) /
+                       1e6;
+    std::cout << "history window: " << std::fixed << std::setprecision(1)
+              << window_ms << "ms\n\n";
+    std::cout.unsetf(std::ios::fixed);
+  }
+
+  w4::PrintFlightTimeline(std::cout, *dump, last_frames);
+  return 0;
+}
@@ -0,0 +1,233 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：虚拟时钟流水线仿真 - 快于实时地探索队列参数
+//
+// 知识点：
+// 1. 与 producer_consumer.cpp 的 Test 2 相同的参数，仿真不需要等待真实时间
+// 2. 同一种子两次运行结果逐项相同
+// 3. 百万帧级别扫描：容量 × 丢帧策略 × 消费者数量
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "pipeline_sim.hpp"
+
+namespace w4 {
+
+namespace {
+
+using WallClock = std::chrono::steady_clock;
+
+double WallMs(WallClock::time_point start) {
+  return std::chrono::duration<double, std::milli>(WallClock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+// 测试1：复现 TestProducerConsumer 的配置（60 FPS、2 个消费者、容量 16、30 帧）
+void TestMirrorRealPipeline() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 1: Mirror of Producer-Consumer Test on Virtual Clock\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  SimConfig config;
+  auto start = WallClock::now();
+  SimReport report = PipelineSimulator(config).Run();
+  double wall_ms = WallMs(start);
+
+  std::cout << report.ToString() << "\n";
+  std::cout << "Simulated " << static_cast<double>(report.sim_duration) /
+                                   kSimMillisecond
+            << " ms in " << wall_ms << " ms wall time\n";
+
+  if (report.captured == 30 && report.consumed == 30) {
+    std::cout << "[PASSED] Mirror pipeline test\n";
+  } else {
+    std::cout << "[FAILED] Mirror pipeline test\n";
+  }
+}
+
+// 测试2：确定性 - 同一种子结果相同，不同种子结果不同
+void TestDeterminism() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 2: Seeded Determinism\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  SimConfig config;
+  config.total_frames = 100000;
+  config.target_fps = 150.0;
+  config.policy = OverflowPolicy::kBlockWithTimeout;
+  config.push_timeout = 5 * kSimMillisecond;
+
+  PipelineSimulator simulator(config);
+  SimReport first = simulator.Run();
+  SimReport second = simulator.Run();
+
+  config.seed = 7;
+  SimReport other_seed = PipelineSimulator(config).Run();
+
+  std::cout << "seed 42 run 1: " << first.ToString() << "\n";
+  std::cout << "seed 42 run 2: " << second.ToString() << "\n";
+  std::cout << "seed 7       : " << other_seed.ToString() << "\n";
+
+  if (first == second && !(first == other_seed)) {
+    std::cout << "[PASSED] Determinism test\n";
+  } else {
+    std::cout << "[FAILED] Determinism test\n";
+  }
+}
+
+// 测试3：参数扫描 - 每个组合一百万帧
+// 校验：
+// - 同一策略、同一消费者数量下，丢帧率不随容量增大而上升
+// - 最大容量且 ρ < 1 时不丢帧；最坏处理时间也不超过 消费者数 / fps 时
+//   帧到达时总有空闲消费者，排队延迟为 0
+void TestParameterSweep() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 3: Capacity x Policy x Consumers Sweep (1M frames each)\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  const size_t capacities[] = {4, 16, 64};
+  const OverflowPolicy policies[] = {
+      OverflowPolicy::kBlock, OverflowPolicy::kBlockWithTimeout,
+      OverflowPolicy::kDropNewest, OverflowPolicy::kDropOldest};
+  const int consumer_counts[] = {1, 2, 3};
+
+  std::cout << std::left << std::setw(6) << "cap" << std::setw(13) << "policy"
+            << std::setw(6) << "cons" << std::right << std::setw(9) << "drop%"
+            << std::setw(10) << "avg_occ" << std::setw(12) << "q_p99(ms)"
+            << std::setw(12) << "e2e_p99" << std::setw(10) << "fps"
+            << "\n";
+
+  // 1M 帧的丢帧率受抽样噪声影响，单调性比较允许 0.1 个百分点的误差
+  constexpr double kDropRateTolerance = 1e-3;
+  double previous_drop_rate[4][3] = {};
+  std::string failures;
+
+  auto start = WallClock::now();
+  uint64_t total_frames = 0;
+  for (size_t c = 0; c < std::size(capacities); ++c) {
+    const size_t capacity = capacities[c];
+    for (size_t p = 0; p < std::size(policies); ++p) {
+      const OverflowPolicy policy = policies[p];
+      for (size_t n = 0; n < std::size(consumer_counts); ++n) {
+        const int consumers = consumer_counts[n];
+        SimConfig config;
+        config.capacity = capacity;
+        config.policy = policy;
+        config.num_consumers = consumers;
+        config.target_fps = 150.0;  // 平均处理 12.5ms，2 个消费者上限约 160 FPS
+        config.push_timeout = 10 * kSimMillisecond;
+        config.total_frames = 1000000;
+
+        SimReport r = PipelineSimulator(config).Run();
+        total_frames += r.captured;
+
+        std::cout << std::left << std::setw(6) << capacity << std::setw(13)
+                  << OverflowPolicyName(policy) << std::setw(6) << consumers
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(9) << r.DropRate() * 100.0 << std::setw(10)
+                  << r.avg_occupancy << std::setw(12) << r.p99_queue_ms
+                  << std::setw(12) << r.p99_e2e_ms << std::setw(10)
+                  << r.ThroughputFps() << "\n";
+        std::cout.unsetf(std::ios::fixed);
+
+        std::string label = std::to_string(capacity) + "/" +
+                            OverflowPolicyName(policy) + "/" +
+                            std::to_string(consumers);
+        if (c > 0 &&
+            r.DropRate() > previous_drop_rate[p][n] + kDropRateTolerance) {
+          failures += " drop rate grew with capacity (" + label + ")";
+        }
+        previous_drop_rate[p][n] = r.DropRate();
+
+        double mean_service_s =
+            static_cast<double>(config.service_min + config.service_max) / 2.0 /
+            kSimSecond;
+        double rho = config.target_fps * mean_service_s / consumers;
+        double worst_load = config.target_fps *
+                            static_cast<double>(config.service_max) /
+                            kSimSecond / consumers;
+        if (c + 1 == std::size(capacities) && rho < 1.0) {
+          if (r.Dropped() != 0) {
+            failures += " drops at rho<1 (" + label + ")";
+          }
+          if (worst_load <= 1.0 && r.p99_queue_ms > 0.001) {
+            failures += " queueing without overload (" + label + ")";
+          }
+        }
+      }
+    }
+  }
+  double wall_ms = WallMs(start);
+
+  std::cout << "Simulated " << total_frames << " frames in " << std::fixed
+            << std::setprecision(1) << wall_ms << " ms wall time\n";
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << std::setprecision(6);
+  if (failures.empty()) {
+    std::cout << "[PASSED] Parameter sweep\n";
+  } else {
+    std::cout << "[FAILED] Parameter sweep:" << failures << "\n";
+  }
+}
+
+// 测试4：无效配置在构造时被拒绝
+void TestConfigValidation() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 4: Invalid SimConfig Rejected\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  auto Rejected = [](const SimConfig& config) {
+    try {
+      PipelineSimulator simulator(config);
+    } catch (const std::invalid_argument& e) {
+      std::cout << "Rejected: " << e.what() << "\n";
+      return true;
+    }
+    return false;
+  };
+
+  SimConfig zero_fps;
+  zero_fps.target_fps = 0.0;
+  SimConfig zero_capacity;
+  zero_capacity.capacity = 0;
+  zero_capacity.policy = OverflowPolicy::kDropOldest;
+  SimConfig no_consumers;
+  no_consumers.num_consumers = 0;
+  SimConfig inverted_service;
+  inverted_service.service_min = 20 * kSimMillisecond;
+  inverted_service.service_max = 5 * kSimMillisecond;
+
+  bool all_rejected = Rejected(zero_fps) && Rejected(zero_capacity) &&
+                      Rejected(no_consumers) && Rejected(inverted_service);
+  bool default_accepted = !Rejected(SimConfig{});
+
+  if (all_rejected && default_accepted) {
+    std::cout << "[PASSED] Config validation test\n";
+  } else {
+    std::cout << "[FAILED] Config validation test\n";
+  }
+}
+
+}  // namespace w4
+
+int main() {
+  std::cout << "========================================\n";
+  std::cout << "W4: 虚拟时钟流水线仿真\n";
+  std::cout << "========================================\n";
+
+  w4::TestMirrorRealPipeline();
+  w4::TestDeterminism();
+  w4::TestParameterSweep();
+  w4::TestConfigValidation();
+
+  std::cout << "\n========================================\n";
+  std::cout << "All tests completed!\n";
+  std::cout << "========================================\n";
+  return 0;
+}
@@ -0,0 +1,442 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：虚拟时钟 + 离散事件仿真，快于实时地评估生产者-消费者流水线
+//
+// 知识点：
+// 1. 离散事件仿真（DES）：时间只在事件之间"跳跃"，不真正 sleep
+// 2. 确定性：固定随机种子 + 同时刻事件按调度顺序执行 → 结果可精确复现
+// 3. 用同一套参数（容量、丢帧策略、消费者数量）模拟 ImageProducer/ImageConsumer
+
+#ifndef W4_THREADING_PIPELINE_SIM_HPP_
+#define W4_THREADING_PIPELINE_SIM_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么不直接让线程跑在虚拟时钟上？
+// =============================================================================
+// 真实线程即使把 sleep_for 换成"虚拟 sleep"，唤醒顺序仍由 OS 调度器决定，
+// 同一个种子两次运行的交错顺序不同，结果无法复现。
+// 因此这里把生产者、消费者和超时都建模为虚拟时钟上的事件：
+//   - 生产者：每 1/fps 秒产生一个"采集"事件
+//   - 消费者：出队后调度一个"处理完成"事件（处理时间按种子随机）
+//   - 超时：Push 阻塞时调度一个"超时"事件，空位先到则取消
+// 单线程执行，一百万帧只需几百毫秒。
+// =============================================================================
+
+using SimTime = int64_t;  // 虚拟时间，单位：纳秒
+
+constexpr SimTime kSimMicrosecond = 1000;
+constexpr SimTime kSimMillisecond = 1000 * kSimMicrosecond;
+constexpr SimTime kSimSecond = 1000 * kSimMillisecond;
+
+// =============================================================================
+// VirtualClock 类 - 事件驱动的虚拟时钟
+// =============================================================================
+class VirtualClock {
+ public:
+  using EventId = uint64_t;
+  using Callback = std::function<void()>;
+
+  SimTime Now() const { return now_; }
+
+  // 在 delay 之后执行 callback；同一时刻的事件按调度顺序执行（保证确定性）
+  EventId Schedule(SimTime delay, Callback callback) {
+    EventId id = next_id_++;
+    events_.push(Event{now_ + std::max<SimTime>(delay, 0), id,
+                       std::move(callback)});
+    return id;
+  }
+
+  // 取消尚未执行的事件（用于超时：等待条件先满足时撤销超时事件）
+  void Cancel(EventId id) { cancelled_.insert(id); }
+
+  // 执行下一个事件，时钟直接跳到该事件的时刻；无事件时返回 false
+  bool Step() {
+    while (!events_.empty()) {
+      Event event = events_.top();
+      events_.pop();
+      if (cancelled_.erase(event.id) > 0) continue;
+      now_ = event.time;
+      ++executed_;
+      event.callback();
+      return true;
+    }
+    return false;
+  }
+
+  void RunUntilIdle() {
+    while (Step()) {
+    }
+  }
+
+  uint64_t ExecutedEvents() const { return executed_; }
+
+ private:
+  struct Event {
+    SimTime time;
+    EventId id;
+    Callback callback;
+
+    // priority_queue 是大顶堆，反转比较得到"最早、最先调度"的事件
+    bool operator<(const Event& other) const {
+      if (time != other.time) return time > other.time;
+      return id > other.id;
+    }
+  };
+
+  SimTime now_ = 0;
+  EventId next_id_ = 0;
+  uint64_t executed_ = 0;
+  std::priority_queue<Event> events_;
+  std::unordered_set<EventId> cancelled_;
+};
+
+// =============================================================================
+// 仿真配置与报告
+// =============================================================================
+
+// 队列满时生产者的行为
+enum class OverflowPolicy {
+  kBlock,             // 阻塞直到有空位（ThreadSafeRingBuffer::Push 默认行为）
+  kBlockWithTimeout,  // 阻塞，超时则丢弃该帧（Push(item, timeout)）
+  kDropNewest,        // 直接丢弃新帧
+  kDropOldest,        // 覆盖最旧的帧（实时场景常用：宁可丢旧帧）
+};
+
+inline const char* OverflowPolicyName(OverflowPolicy policy) {
+  switch (policy) {
+    case OverflowPolicy::kBlock:
+      return "block";
+    case OverflowPolicy::kBlockWithTimeout:
+      return "timeout";
+    case OverflowPolicy::kDropNewest:
+      return "drop-newest";
+    case OverflowPolicy::kDropOldest:
+      return "drop-oldest";
+  }
+  return "unknown";
+}
+
+struct SimConfig {
+  size_t capacity = 16;
+  int num_consumers = 2;
+  double target_fps = 60.0;
+  uint64_t total_frames = 30;
+  SimTime service_min = 5 * kSimMillisecond;   // 与 ConsumerLoop 的 5-20ms 一致
+  SimTime service_max = 20 * kSimMillisecond;
+  // 非空时改为从实测样本中等概率抽取处理时间（忽略 service_min/max），
+  // 用于按真实负载的经验分布做仿真（见 capacity_tuner.hpp）
+  std::vector<SimTime> service_samples;
+  // 非空时帧间隔同样从实测样本中等概率抽取（忽略 target_fps），
+  // 保留真实采集的抖动和突发，而不是严格周期的到达
+  std::vector<SimTime> interarrival_samples;
+  OverflowPolicy policy = OverflowPolicy::kBlock;
+  SimTime push_timeout = 100 * kSimMillisecond;  // 仅 kBlockWithTimeout 使用
+  uint64_t seed = 42;
+};
+
+struct SimReport {
+  uint64_t captured = 0;         // 生产者采集的帧数
+  uint64_t enqueued = 0;         // 成功入队
+  uint64_t dropped_newest = 0;   // 因队列满被丢弃的新帧
+  uint64_t dropped_oldest = 0;   // 被覆盖的旧帧
+  uint64_t timed_out = 0;        // Push 超时丢弃
+  uint64_t consumed = 0;
+  size_t max_occupancy = 0;
+  double avg_occupancy = 0.0;    // 按时间加权的平均队列长度
+  double avg_queue_ms = 0.0;     // 采集 → 出队（与 ConsumerLoop 的 latency 定义一致）
+  double p99_queue_ms = 0.0;
+  double avg_e2e_ms = 0.0;       // 采集 → 处理完成
+  double p99_e2e_ms = 0.0;
+  SimTime sim_duration = 0;
+  uint64_t events = 0;
+
+  uint64_t Dropped() const { return dropped_newest + dropped_oldest + timed_out; }
+
+  double DropRate() const {
+    return captured == 0 ? 0.0
+                         : static_cast<double>(Dropped()) /
+                               static_cast<double>(captured);
+  }
+
+  double ThroughputFps() const {
+    return sim_duration == 0 ? 0.0
+                             : static_cast<double>(consumed) * kSimSecond /
+                                   static_cast<double>(sim_duration);
+  }
+
+  bool operator==(const SimReport& other) const {
+    return captured == other.captured && enqueued == other.enqueued &&
+           Dropped() == other.Dropped() && consumed == other.consumed &&
+           max_occupancy == other.max_occupancy &&
+           avg_queue_ms == other.avg_queue_ms &&
+           p99_e2e_ms == other.p99_e2e_ms &&
+           sim_duration == other.sim_duration && events == other.events;
+  }
+
+  std::string ToString() const {
+    std::ostringstream oss;
+    oss << "captured=" << captured << ", consumed=" << consumed
+        << ", dropped=" << Dropped() << " (" << DropRate() * 100.0 << "%)"
+        << ", max_occ=" << max_occupancy << ", avg_occ=" << avg_occupancy
+        << ", queue avg/p99=" << avg_queue_ms << "/" << p99_queue_ms << "ms"
+        << ", e2e avg/p99=" << avg_e2e_ms << "/" << p99_e2e_ms << "ms";
+    return oss.str();
+  }
+};
+
+// =============================================================================
+// PipelineSimulator 类 - 在虚拟时钟上复现 ImageProducer → RingBuffer → ImageConsumer
+// =============================================================================
+class PipelineSimulator {
+ public:
+  // 抛 std::invalid_argument：配置无法对应真实流水线
+  // （帧率 <= 0、容量为 0、没有消费者、处理时间区间为空或为负）
+  explicit PipelineSimulator(const SimConfig& config)
+      : config_(Validate(config)), rng_(config.seed) {}
+
+  // 每次 Run() 都从虚拟时刻 0 和初始种子开始，同一配置多次运行结果完全相同
+  SimReport Run() {
+    clock_ = VirtualClock{};
+    rng_.seed(config_.seed);
+    arrival_rng_.seed(config_.seed ^ kArrivalSeedSalt);
+    report_ = SimReport{};
+    queue_.clear();
+    idle_consumers_.clear();
+    queue_latencies_.clear();
+    e2e_latencies_.clear();
+    queue_latencies_.reserve(static_cast<size_t>(config_.total_frames));
+    e2e_latencies_.reserve(static_cast<size_t>(config_.total_frames));
+    occupancy_area_ = 0.0;
+    last_change_ = 0;
+    blocked_ = false;
+    next_frame_ = 0;
+
+    if (config_.interarrival_samples.empty()) {
+      frame_interval_ = static_cast<SimTime>(static_cast<double>(kSimSecond) /
+                                             config_.target_fps);
+    }
+    for (int i = 0; i < config_.num_consumers; ++i) idle_consumers_.push_back(i);
+
+    clock_.Schedule(0, [this]() { CaptureFrame(); });
+    clock_.RunUntilIdle();
+
+    report_.sim_duration = clock_.Now();
+    report_.events = clock_.ExecutedEvents();
+    if (report_.sim_duration > 0) {
+      report_.avg_occupancy =
+          occupancy_area_ / static_cast<double>(report_.sim_duration);
+    }
+    report_.avg_queue_ms = Mean(queue_latencies_);
+    report_.p99_queue_ms = Percentile(queue_latencies_, 0.99);
+    report_.avg_e2e_ms = Mean(e2e_latencies_);
+    report_.p99_e2e_ms = Percentile(e2e_latencies_, 0.99);
+    return report_;
+  }
+
+ private:
+  // 到达间隔用独立的随机流：是否启用经验到达分布不影响处理时间序列
+  static constexpr uint64_t kArrivalSeedSalt = 0x9E3779B97F4A7C15ULL;
+
+  static const SimConfig& Validate(const SimConfig& config) {
+    if (config.interarrival_samples.empty() && !(config.target_fps > 0.0)) {
+      throw std::invalid_argument("SimConfig: target_fps must be > 0");
+    }
+    if (!config.interarrival_samples.empty() &&
+        (*std::min_element(config.interarrival_samples.begin(),
+                           config.interarrival_samples.end()) < 0 ||
+         *std::max_element(config.interarrival_samples.begin(),
+                           config.interarrival_samples.end()) == 0)) {
+      throw std::invalid_argument(
+          "SimConfig: interarrival_samples must be >= 0 and not all zero");
+    }
+    // 容量为 0 时 kDropOldest 会在空队列上 pop_front，kBlock 永远无法入队
+    if (config.capacity == 0) {
+      throw std::invalid_argument("SimConfig: capacity must be > 0");
+    }
+    if (config.num_consumers <= 0) {
+      throw std::invalid_argument("SimConfig: num_consumers must be > 0");
+    }
+    if (config.service_samples.empty() &&
+        (config.service_min < 0 || config.service_max < config.service_min)) {
+      throw std::invalid_argument(
+          "SimConfig: need 0 <= service_min <= service_max");
+    }
+    return config;
+  }
+
+  // ---------------------------------------------------------------------------
+  // 生产者：对应 ProducerLoop 的"采集 → Push → 按帧间隔补足 sleep"
+  // ---------------------------------------------------------------------------
+  void CaptureFrame() {
+    if (next_frame_ >= config_.total_frames) return;
+    ++next_frame_;
+    ++report_.captured;
+    frame_start_ = clock_.Now();
+    if (!config_.interarrival_samples.empty()) {
+      frame_interval_ = config_.interarrival_samples
+          [arrival_rng_() % config_.interarrival_samples.size()];
+    }
+    SimTime capture_time = clock_.Now();
+
+    if (queue_.size() < config_.capacity) {
+      Enqueue(capture_time);
+      ScheduleNextCapture();
+      return;
+    }
+
+    switch (config_.policy) {
+      case OverflowPolicy::kDropNewest:
+        ++report_.dropped_newest;
+        ScheduleNextCapture();
+        break;
+      case OverflowPolicy::kDropOldest:
+        RecordOccupancy();
+        queue_.pop_front();
+        ++report_.dropped_oldest;
+        Enqueue(capture_time);
+        ScheduleNextCapture();
+        break;
+      case OverflowPolicy::kBlock:
+        BlockProducer(capture_time, false);
+        break;
+      case OverflowPolicy::kBlockWithTimeout:
+        BlockProducer(capture_time, true);
+        break;
+    }
+  }
+
+  void BlockProducer(SimTime capture_time, bool with_timeout) {
+    blocked_ = true;
+    blocked_capture_time_ = capture_time;
+    if (with_timeout) {
+      timeout_event_ = clock_.Schedule(config_.push_timeout, [this]() {
+        blocked_ = false;
+        ++report_.timed_out;
+        ScheduleNextCapture();
+      });
+    }
+  }
+
+  // 出队后若生产者阻塞在 Push 上，则唤醒它（取消超时事件）
+  void WakeBlockedProducer() {
+    if (!blocked_) return;
+    blocked_ = false;
+    if (config_.policy == OverflowPolicy::kBlockWithTimeout) {
+      clock_.Cancel(timeout_event_);
+    }
+    Enqueue(blocked_capture_time_);
+    ScheduleNextCapture();
+  }
+
+  void ScheduleNextCapture() {
+    SimTime elapsed = clock_.Now() - frame_start_;
+    SimTime delay = elapsed < frame_interval_ ? frame_interval_ - elapsed : 0;
+    clock_.Schedule(delay, [this]() { CaptureFrame(); });
+  }
+
+  void Enqueue(SimTime capture_time) {
+    RecordOccupancy();
+    queue_.push_back(capture_time);
+    ++report_.enqueued;
+    report_.max_occupancy = std::max(report_.max_occupancy, queue_.size());
+    DispatchToIdleConsumer();
+  }
+
+  // ---------------------------------------------------------------------------
+  // 消费者：对应 ConsumerLoop 的"Pop → 处理 process_time"
+  // ---------------------------------------------------------------------------
+  void DispatchToIdleConsumer() {
+    while (!idle_consumers_.empty() && !queue_.empty()) {
+      int consumer = idle_consumers_.front();
+      idle_consumers_.pop_front();
+
+      RecordOccupancy();
+      SimTime capture_time = queue_.front();
+      queue_.pop_front();
+      queue_latencies_.push_back(clock_.Now() - capture_time);
+
+      SimTime service = ServiceTime();
+      clock_.Schedule(service, [this, consumer, capture_time]() {
+        ++report_.consumed;
+        e2e_latencies_.push_back(clock_.Now() - capture_time);
+        idle_consumers_.push_back(consumer);
+        DispatchToIdleConsumer();
+      });
+
+      WakeBlockedProducer();
+    }
+  }
+
+  // 均匀分布（或经验分布）处理时间；不用 std::uniform_int_distribution，
+  // 因为其实现因标准库而异，自己映射可保证跨平台复现
+  SimTime ServiceTime() {
+    if (!config_.service_samples.empty()) {
+      return config_.service_samples[rng_() % config_.service_samples.size()];
+    }
+    SimTime span = config_.service_max - config_.service_min;
+    if (span <= 0) return config_.service_min;
+    return config_.service_min +
+           static_cast<SimTime>(rng_() % static_cast<uint64_t>(span + 1));
+  }
+
+  // 时间加权的队列长度积分（用于平均占用率）
+  void RecordOccupancy() {
+    SimTime now = clock_.Now();
+    occupancy_area_ +=
+        static_cast<double>(queue_.size()) * static_cast<double>(now - last_change_);
+    last_change_ = now;
+  }
+
+  static double Mean(const std::vector<SimTime>& values) {
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (SimTime v : values) sum += static_cast<double>(v);
+    return sum / static_cast<double>(values.size()) / kSimMillisecond;
+  }
+
+  static double Percentile(std::vector<SimTime>& values, double q) {
+    if (values.empty()) return 0.0;
+    size_t k = static_cast<size_t>(q * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<long>(k),
+                     values.end());
+    return static_cast<double>(values[k]) / kSimMillisecond;
+  }
+
+  SimConfig config_;
+  std::mt19937_64 rng_;
+  std::mt19937_64 arrival_rng_;
+  VirtualClock clock_;
+  SimReport report_;
+
+  std::deque<SimTime> queue_;       // 队列中每帧的采集时刻
+  std::deque<int> idle_consumers_;  // 空闲消费者（FIFO，保证确定性）
+  std::vector<SimTime> queue_latencies_;
+  std::vector<SimTime> e2e_latencies_;
+
+  SimTime frame_interval_ = 0;
+  SimTime frame_start_ = 0;
+  uint64_t next_frame_ = 0;
+  bool blocked_ = false;
+  SimTime blocked_capture_time_ = 0;
+  VirtualClock::EventId timeout_event_ = 0;
+  double occupancy_area_ = 0.0;
+  SimTime last_change_ = 0;
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_PIPELINE_SIM_HPP_
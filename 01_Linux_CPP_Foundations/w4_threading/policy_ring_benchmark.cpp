@@ -0,0 +1,188 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：PolicyRingBuffer 静态基准矩阵 - 每种策略组合都是独立实例化的类型
+//
+// 知识点：
+// 1. 变参模板 + 折叠表达式在编译期展开整个测试矩阵
+// 2. 对比：SPSC 无锁 vs MPMC 加锁、忙等 vs 让出 vs 睡眠、阻塞 vs 丢帧
+// 3. 统计策略开 / 关的开销，以及 sizeof 的差别（空基类优化）
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "policy_ring_buffer.hpp"
+
+namespace w4 {
+
+namespace {
+
+constexpr size_t kCapacity = 256;
+constexpr int kItemsPerProducer = 200000;
+
+template <typename T>
+struct TypeTag {
+  using type = T;
+};
+
+// 一个矩阵单元：缓冲区类型 + 生产者/消费者线程数
+template <typename Card, typename Wait, typename OverflowPolicyT, typename InstrPolicy>
+struct Config {
+  using Overflow = OverflowPolicyT;
+  using Instr = InstrPolicy;
+  using Buffer = PolicyRingBuffer<uint64_t, kCapacity, Card, Wait, Overflow, Instr>;
+  static constexpr int kThreads =
+      std::is_same_v<Card, SingleProducerSingleConsumer> ? 1 : 2;
+
+  static std::string Name() {
+    return std::string(Card::kName) + "/" + Wait::kName + "/" +
+           Overflow::kName + "/stats-" + Instr::kName;
+  }
+};
+
+struct CaseResult {
+  double mops = 0.0;
+  uint64_t consumed = 0;
+  uint64_t produced = 0;
+  bool accounted = true;  // 阻塞策略不丢；丢帧策略 consumed + dropped == produced
+};
+
+template <typename Cfg>
+CaseResult RunCase() {
+  using Buffer = typename Cfg::Buffer;
+  Buffer buffer;
+  std::atomic<uint64_t> consumed(0);
+  std::atomic<uint64_t> rejected(0);  // DropNewest 时 Push 返回 false 的次数
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < Cfg::kThreads; ++c) {
+    consumers.emplace_back([&]() {
+      uint64_t local = 0;
+      while (buffer.Pop()) ++local;
+      consumed += local;
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < Cfg::kThreads; ++p) {
+    producers.emplace_back([&]() {
+      uint64_t local_rejected = 0;
+      for (int i = 0; i < kItemsPerProducer; ++i) {
+        if (!buffer.Push(static_cast<uint64_t>(i))) ++local_rejected;
+      }
+      rejected += local_rejected;
+    });
+  }
+  for (auto& t : producers) t.join();
+  buffer.Stop();
+  for (auto& t : consumers) t.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  CaseResult r;
+  r.produced = static_cast<uint64_t>(Cfg::kThreads) * kItemsPerProducer;
+  r.consumed = consumed;
+  r.mops = static_cast<double>(r.produced) / seconds / 1e6;
+
+  // 守恒校验：被覆盖的元素只有打开统计时才数得到
+  using Overflow = typename Cfg::Overflow;
+  if constexpr (std::is_same_v<Overflow, OverflowBlock>) {
+    r.accounted = rejected == 0 && r.consumed == r.produced;
+  } else if constexpr (std::is_same_v<Overflow, OverflowDropNewest>) {
+    r.accounted = r.consumed + rejected == r.produced;
+  } else {
+    r.accounted = rejected == 0 && r.consumed <= r.produced;
+  }
+  if constexpr (std::is_same_v<typename Cfg::Instr, CountingInstrumentation>) {
+    const auto& stats = buffer.Stats();
+    r.accounted = r.accounted && stats.popped == r.consumed;
+    if constexpr (std::is_same_v<Overflow, OverflowDropOldest>) {
+      r.accounted = r.accounted && r.consumed + stats.dropped == r.produced;
+    }
+  }
+  return r;
+}
+
+// 折叠表达式：对每个 Config 实例化并运行一次
+template <typename... Configs>
+bool RunMatrix() {
+  bool all_ok = true;
+  auto run_one = [&all_ok](auto tag) {
+    using Cfg = typename decltype(tag)::type;
+    CaseResult r = RunCase<Cfg>();
+    std::cout << std::left << std::setw(36) << Cfg::Name() << std::right
+              << std::setw(8) << sizeof(typename Cfg::Buffer) << std::fixed
+              << std::setprecision(2) << std::setw(10) << r.mops
+              << std::setw(12) << r.consumed << std::setw(10)
+              << (r.accounted ? "ok" : "BROKEN") << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    all_ok = all_ok && r.accounted;
+  };
+  (run_one(TypeTag<Configs>{}), ...);
+  return all_ok;
+}
+
+}  // namespace
+
+void RunPolicyMatrix() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Benchmark: Policy Matrix (" << kItemsPerProducer
+            << " items/producer, capacity " << kCapacity << ")\n";
+  std::cout << std::string(60, '=') << "\n";
+  std::cout << "SPSC cases use 1 producer + 1 consumer, MPMC cases 2 + 2\n";
+  std::cout << std::left << std::setw(36) << "cardinality/wait/overflow/stats"
+            << std::right << std::setw(8) << "sizeof" << std::setw(10)
+            << "Mops/s" << std::setw(12) << "consumed" << std::setw(10)
+            << "balance" << "\n";
+
+  using SPSC = SingleProducerSingleConsumer;
+  using MPMC = MultiProducerMultiConsumer;
+  bool ok = RunMatrix<
+      // 等待方式（SPSC，阻塞）
+      Config<SPSC, SpinWait, OverflowBlock, NoInstrumentation>,
+      Config<SPSC, YieldWait, OverflowBlock, NoInstrumentation>,
+      Config<SPSC, BlockingWait, OverflowBlock, NoInstrumentation>,
+      // 等待方式（MPMC，阻塞）：接近 ThreadSafeRingBuffer 的是 block
+      Config<MPMC, SpinWait, OverflowBlock, NoInstrumentation>,
+      Config<MPMC, YieldWait, OverflowBlock, NoInstrumentation>,
+      Config<MPMC, BlockingWait, OverflowBlock, NoInstrumentation>,
+      // 溢出行为
+      Config<SPSC, BlockingWait, OverflowDropNewest, NoInstrumentation>,
+      Config<MPMC, BlockingWait, OverflowDropNewest, NoInstrumentation>,
+      Config<MPMC, BlockingWait, OverflowDropOldest, NoInstrumentation>,
+      // 统计开关的开销
+      Config<SPSC, BlockingWait, OverflowBlock, CountingInstrumentation>,
+      Config<MPMC, BlockingWait, OverflowBlock, CountingInstrumentation>,
+      Config<MPMC, BlockingWait, OverflowDropOldest, CountingInstrumentation>>();
+
+  // 不合法的组合在编译期就被拒绝，例如：
+  //   PolicyRingBuffer<int, 8, SPSC, SpinWait, OverflowDropOldest> bad;  // static_assert
+
+  if (ok) {
+    std::cout << "[PASSED] Every combination balanced its books\n";
+  } else {
+    std::cout << "[FAILED] Lost or duplicated items detected\n";
+  }
+}
+
+}  // namespace w4
+
+int main() {
+  std::cout << "========================================\n";
+  std::cout << "W4: 策略化环形缓冲区基准矩阵\n";
+  std::cout << "========================================\n";
+
+  w4::RunPolicyMatrix();
+
+  std::cout << "\n========================================\n";
+  std::cout << "All benchmarks completed!\n";
+  std::cout << "========================================\n";
+  return 0;
+}
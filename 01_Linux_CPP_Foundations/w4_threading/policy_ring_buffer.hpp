@@ -0,0 +1,359 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：基于策略的环形缓冲区 - 编译期组合同步方式、等待方式、溢出行为和统计
+//
+// 知识点：
+// 1. Policy-based design：每个维度是一个类型参数，组合在编译期完成
+// 2. if constexpr 与空策略：未选用的分支和空统计函数不会生成任何代码
+// 3. 空基类优化（EBO）：关闭统计时不占用额外内存
+// 4. 不合法的组合用 static_assert 在编译期拒绝
+
+#ifndef W4_THREADING_POLICY_RING_BUFFER_HPP_
+#define W4_THREADING_POLICY_RING_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+#include "sharded_queue.hpp"  // SpscLane, EventCount
+
+namespace w4 {
+
+// =============================================================================
+// 四个策略维度
+// =============================================================================
+// ThreadSafeRingBuffer 固定为：多生产者多消费者 + 互斥锁 + 条件变量 + 满时阻塞。
+// PolicyRingBuffer 把这些都变成模板参数：
+//
+//   PolicyRingBuffer<T, Capacity,
+//                    Cardinality,      // SingleProducerSingleConsumer / MultiProducerMultiConsumer
+//                    WaitPolicy,       // SpinWait / YieldWait / BlockingWait
+//                    Overflow,         // OverflowBlock / OverflowDropNewest / OverflowDropOldest
+//                    Instrumentation>  // NoInstrumentation / CountingInstrumentation
+//
+// 所有选择都在编译期决定，热路径上没有 "if (mode == ...)" 之类的运行时分支。
+// =============================================================================
+
+// -----------------------------------------------------------------------------
+// 维度 1：生产者/消费者数量 → 决定底层存储与同步方式
+// -----------------------------------------------------------------------------
+
+// 多生产者多消费者：互斥锁保护下标（与 ThreadSafeRingBuffer 相同），支持覆盖最旧元素
+template <typename T, size_t Capacity>
+class MpmcCore {
+ public:
+  bool TryPush(T& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == Capacity) return false;
+    slots_[tail_] = std::move(item);
+    tail_ = (tail_ + 1) % Capacity;
+    ++count_;
+    return true;
+  }
+
+  // 满时覆盖最旧的元素，返回是否发生了覆盖
+  bool PushOverwrite(T& item) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool overwritten = count_ == Capacity;
+    if (overwritten) {
+      head_ = (head_ + 1) % Capacity;
+      --count_;
+    }
+    slots_[tail_] = std::move(item);
+    tail_ = (tail_ + 1) % Capacity;
+    ++count_;
+    return overwritten;
+  }
+
+  std::optional<T> TryPop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == 0) return std::nullopt;
+    T item = std::move(slots_[head_]);
+    head_ = (head_ + 1) % Capacity;
+    --count_;
+    return item;
+  }
+
+  bool Empty() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_ == 0;
+  }
+
+ private:
+  std::array<T, Capacity> slots_;
+  size_t head_ = 0;
+  size_t tail_ = 0;
+  size_t count_ = 0;
+  mutable std::mutex mutex_;
+};
+
+struct SingleProducerSingleConsumer {
+  static constexpr const char* kName = "SPSC";
+  static constexpr bool kSupportsOverwrite = false;
+  // 无锁 SPSC 通道（要求容量为 2 的幂）
+  template <typename T, size_t Capacity>
+  using Core = SpscLane<T, Capacity>;
+};
+
+struct MultiProducerMultiConsumer {
+  static constexpr const char* kName = "MPMC";
+  static constexpr bool kSupportsOverwrite = true;
+  template <typename T, size_t Capacity>
+  using Core = MpmcCore<T, Capacity>;
+};
+
+// -----------------------------------------------------------------------------
+// 维度 2：等待方式
+// -----------------------------------------------------------------------------
+// 统一接口：Await(try_op, deadline) 反复尝试 try_op()（有副作用，成功即完成操作），
+// 直到成功返回 true，或到达截止时间返回 false；Notify() 在状态变化后调用。
+// -----------------------------------------------------------------------------
+using PolicyClock = std::chrono::steady_clock;
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+// 忙等：延迟最低，但占满一个核；自旋一段时间仍失败才让出 CPU，
+// 否则单核机器上会把对端线程饿死整整一个时间片。
+// 读时钟（vDSO 上也要几十纳秒）比一次 pause 还贵：无截止时间时不读，
+// 自旋阶段每 kSpinsPerClockCheck 次才读一次，让出阶段每次都读
+struct SpinWait {
+  static constexpr const char* kName = "spin";
+  static constexpr int kSpinsBeforeYield = 1024;
+  static constexpr int kSpinsPerClockCheck = 64;
+
+  template <typename TryOp>
+  bool Await(TryOp&& try_op, PolicyClock::time_point deadline) {
+    const bool timed = deadline != PolicyClock::time_point::max();
+    for (int spins = 0;; ++spins) {
+      if (try_op()) return true;
+      if (spins < kSpinsBeforeYield) {
+        if (timed && spins % kSpinsPerClockCheck == 0 &&
+            PolicyClock::now() >= deadline) {
+          return false;
+        }
+        CpuRelax();
+      } else {
+        if (timed && PolicyClock::now() >= deadline) return false;
+        std::this_thread::yield();
+      }
+    }
+  }
+  void Notify() {}  // 等待方自己轮询，无需唤醒
+};
+
+// 每次失败都让出 CPU
+struct YieldWait {
+  static constexpr const char* kName = "yield";
+
+  template <typename TryOp>
+  bool Await(TryOp&& try_op, PolicyClock::time_point deadline) {
+    const bool timed = deadline != PolicyClock::time_point::max();
+    while (!try_op()) {
+      if (timed && PolicyClock::now() >= deadline) return false;
+      std::this_thread::yield();
+    }
+    return true;
+  }
+  void Notify() {}
+};
+
+// 真正睡眠：基于 EventCount，无人等待时 Notify 只有一次原子读
+struct BlockingWait {
+  static constexpr const char* kName = "block";
+  static constexpr std::chrono::milliseconds kWaitSlice{10};
+
+  template <typename TryOp>
+  bool Await(TryOp&& try_op, PolicyClock::time_point deadline) {
+    while (true) {
+      if (try_op()) return true;
+      uint64_t key = event_.PrepareWait();
+      if (try_op()) {
+        event_.CancelWait();
+        return true;
+      }
+      auto now = PolicyClock::now();
+      if (now >= deadline) {
+        event_.CancelWait();
+        return false;
+      }
+      auto left =
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+      event_.Wait(key, left < kWaitSlice ? left : kWaitSlice);
+    }
+  }
+  void Notify() { event_.Notify(); }
+
+ private:
+  EventCount event_;
+};
+
+// -----------------------------------------------------------------------------
+// 维度 3：队列满时的行为
+// -----------------------------------------------------------------------------
+struct OverflowBlock {
+  static constexpr const char* kName = "block";
+};
+struct OverflowDropNewest {  // 丢弃新来的元素（Push 返回 false）
+  static constexpr const char* kName = "drop-new";
+};
+struct OverflowDropOldest {  // 覆盖最旧的元素（Push 总是成功）
+  static constexpr const char* kName = "drop-old";
+};
+
+// -----------------------------------------------------------------------------
+// 维度 4：统计
+// -----------------------------------------------------------------------------
+struct NoInstrumentation {
+  static constexpr const char* kName = "off";
+  void OnPush() {}
+  void OnPop() {}
+  void OnDrop() {}
+  void OnWait() {}
+};
+
+struct CountingInstrumentation {
+  static constexpr const char* kName = "on";
+  void OnPush() { pushed.fetch_add(1, std::memory_order_relaxed); }
+  void OnPop() { popped.fetch_add(1, std::memory_order_relaxed); }
+  void OnDrop() { dropped.fetch_add(1, std::memory_order_relaxed); }
+  void OnWait() { waits.fetch_add(1, std::memory_order_relaxed); }
+
+  std::atomic<uint64_t> pushed{0};
+  std::atomic<uint64_t> popped{0};
+  std::atomic<uint64_t> dropped{0};
+  std::atomic<uint64_t> waits{0};  // 进入慢路径（需要等待）的次数
+};
+
+// =============================================================================
+// PolicyRingBuffer 类
+// =============================================================================
+// 接口与 ThreadSafeRingBuffer 保持一致：Push / Pop（可超时）/ Stop。
+// 统计策略作为私有基类（空类不占空间），通过 Stats() 读取。
+// =============================================================================
+template <typename T, size_t Capacity, typename Cardinality = MultiProducerMultiConsumer,
+          typename WaitPolicy = BlockingWait, typename Overflow = OverflowBlock,
+          typename Instrumentation = NoInstrumentation>
+class PolicyRingBuffer : private Instrumentation {
+ public:
+  static_assert(Capacity > 0, "Capacity must be greater than 0");
+  static_assert(!std::is_same_v<Overflow, OverflowDropOldest> ||
+                    Cardinality::kSupportsOverwrite,
+                "OverflowDropOldest needs the producer to advance head, "
+                "which the lock-free SPSC core does not allow");
+
+  using Core = typename Cardinality::template Core<T, Capacity>;
+
+  PolicyRingBuffer() = default;
+  PolicyRingBuffer(const PolicyRingBuffer&) = delete;
+  PolicyRingBuffer& operator=(const PolicyRingBuffer&) = delete;
+
+  // =========================================================================
+  // Push - 行为由 Overflow 策略决定
+  // =========================================================================
+  //   OverflowBlock:      满时等待（可超时），Stop() 后返回 false
+  //   OverflowDropNewest: 满时立即丢弃本元素，返回 false
+  //   OverflowDropOldest: 满时覆盖最旧元素，返回 true
+  // =========================================================================
+  bool Push(T item, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    if (stopped_.load(std::memory_order_acquire)) return false;
+
+    bool pushed = false;
+    if constexpr (std::is_same_v<Overflow, OverflowDropOldest>) {
+      if (core_.PushOverwrite(item)) Instrumentation::OnDrop();
+      pushed = true;
+    } else if constexpr (std::is_same_v<Overflow, OverflowDropNewest>) {
+      pushed = core_.TryPush(item);
+      if (!pushed) Instrumentation::OnDrop();
+    } else {
+      pushed = core_.TryPush(item);
+      if (!pushed) {
+        Instrumentation::OnWait();
+        bool stopped = false;
+        pushed = not_full_.Await(
+                     [&]() {
+                       if (stopped_.load(std::memory_order_acquire)) {
+                         stopped = true;
+                         return true;
+                       }
+                       return core_.TryPush(item);
+                     },
+                     Deadline(timeout)) &&
+                 !stopped;
+      }
+    }
+
+    if (pushed) {
+      Instrumentation::OnPush();
+      not_empty_.Notify();
+    }
+    return pushed;
+  }
+
+  // =========================================================================
+  // Pop - 空时等待（可超时）；Stop() 后仍会先取完剩余数据
+  // =========================================================================
+  std::optional<T> Pop(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::optional<T> item = core_.TryPop();
+    if (!item.has_value()) {
+      Instrumentation::OnWait();
+      not_empty_.Await(
+          [&]() {
+            item = core_.TryPop();
+            if (item.has_value()) return true;
+            // 停止后再确认一次：Stop() 之前完成的 Push 不能丢
+            if (stopped_.load(std::memory_order_acquire)) {
+              item = core_.TryPop();
+              return true;
+            }
+            return false;
+          },
+          Deadline(timeout));
+    }
+
+    if (item.has_value()) {
+      Instrumentation::OnPop();
+      if constexpr (std::is_same_v<Overflow, OverflowBlock>) not_full_.Notify();
+    }
+    return item;
+  }
+
+  // 应在生产者不再 Push 之后调用（与 ShardedQueue 相同的约定）
+  void Stop() {
+    stopped_.store(true, std::memory_order_release);
+    not_empty_.Notify();
+    not_full_.Notify();
+  }
+
+  bool IsStopped() const { return stopped_.load(std::memory_order_acquire); }
+  bool Empty() const { return core_.Empty(); }
+  const Instrumentation& Stats() const { return *this; }
+  static constexpr size_t GetCapacity() { return Capacity; }
+
+ private:
+  static PolicyClock::time_point Deadline(std::chrono::milliseconds timeout) {
+    if (timeout == std::chrono::milliseconds::max()) {
+      return PolicyClock::time_point::max();
+    }
+    return PolicyClock::now() + timeout;
+  }
+
+  Core core_;
+  std::atomic<bool> stopped_{false};
+  WaitPolicy not_empty_;
+  WaitPolicy not_full_;
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_POLICY_RING_BUFFER_HPP_
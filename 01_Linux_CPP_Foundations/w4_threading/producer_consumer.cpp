@@ -10,22 +10,47 @@
 #ifndef W4_THREADING_PRODUCER_CONSUMER_CPP_
 #define W4_THREADING_PRODUCER_CONSUMER_CPP_
 
-#include <array>
+#include <algorithm>
 #include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <cstddef>
+#include <csignal>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <mutex>
 #include <optional>
 #include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "admission_controller.hpp"
+#include "broadcast_ring.hpp"
+#include "capacity_tuner.hpp"
+#include "dynamic_ring_buffer.hpp"
+#include "flight_recorder.hpp"
+#include "profiled_mutex.hpp"
+#include "thread_cpu_stats.hpp"
+#include "thread_safe_ring_buffer.hpp"
+
 // =============================================================================
 // 知识点：为什么需要线程安全的数据结构？
 // =============================================================================
@@ -45,11 +70,14 @@ namespace w4 {
 // =============================================================================
 // std::cout 的格式修改（如 std::fixed）不是线程安全的
 // 使用全局互斥锁保护控制台输出
+//
+// 本文件中的锁都是 ProfiledMutex：程序退出时输出按等待时间排序的争用报告，
+// 用来确认日志锁和缓冲区锁是否真的是热点
 // =============================================================================
-std::mutex g_console_mutex;
+ProfiledMutex g_console_mutex("g_console_mutex");
 
 void ThreadSafeLog(const std::string& message) {
-  std::lock_guard<std::mutex> lock(g_console_mutex);
+  std::lock_guard<ProfiledMutex> lock(g_console_mutex);
   std::cout << message;
 }
 
@@ -61,6 +89,8 @@ void ThreadSafeLog(const std::string& message) {
 // =============================================================================
 class SimulatedImage {
  public:
+  static constexpr int kChannels = 3;  // RGB
+
   SimulatedImage() : id_(0), width_(0), height_(0), timestamp_(0) {}
 
   SimulatedImage(uint64_t id, int width, int height)
@@ -70,7 +100,7 @@ class SimulatedImage {
         timestamp_(
             std::chrono::steady_clock::now().time_since_epoch().count()) {
     // 模拟图像数据（实际场景中这里是像素数据）
-    data_.resize(static_cast<size_t>(width * height * 3));  // RGB格式
+    data_.resize(static_cast<size_t>(width * height * kChannels));  // RGB格式
     // 填充模拟数据
     for (size_t i = 0; i < data_.size(); ++i) {
       data_[i] = static_cast<uint8_t>(i % 256);
@@ -114,6 +144,11 @@ class SimulatedImage {
   int GetHeight() const { return height_; }
   int64_t GetTimestamp() const { return timestamp_; }
   size_t GetDataSize() const { return data_.size(); }
+  int GetChannels() const { return kChannels; }
+
+  // 像素访问（交织 RGB，行主序）
+  const uint8_t* Data() const { return data_.data(); }
+  uint8_t* Data() { return data_.data(); }
 
   std::string ToString() const {
     std::ostringstream oss;
@@ -131,176 +166,103 @@ class SimulatedImage {
 };
 
 // =============================================================================
-// ThreadSafeRingBuffer 类 - 线程安全的环形缓冲区
+// 图像处理负载 - ImageConsumer 可插拔的处理函数
 // =============================================================================
-// 核心设计思想：
-// 1. 使用 std::mutex 保护共享数据（buffer_, head_, tail_, count_）
-// 2. 使用 std::condition_variable 实现阻塞等待
-//    - not_full_cv_: 当缓冲区满时，生产者等待
-//    - not_empty_cv_: 当缓冲区空时，消费者等待
-// 3. 使用 std::atomic<bool> 实现优雅停止
+// 知识点：为什么 sleep_for 不能代表真实处理？
+//   sleep 期间线程让出 CPU，不读写内存，因此测不出：
+//   - 内存带宽（1080p RGB 一帧约 6MB，远超 L2）
+//   - 缓存效应（多个消费者争用 LLC）
+//   - CPU 争用（消费者数 > 核数时吞吐不再增长）
+//
+// 处理函数返回一个摘要值（digest），消费者累加它，
+// 防止编译器把"结果没人用"的计算整体优化掉。
+// 每个消费者持有处理函数的独立副本，内部的临时缓冲区不会被多线程共享。
 // =============================================================================
-template <typename T, size_t Capacity>
-class ThreadSafeRingBuffer {
- public:
-  ThreadSafeRingBuffer() : head_(0), tail_(0), count_(0), stopped_(false) {
-    static_assert(Capacity > 0, "Capacity must be greater than 0");
-  }
-
-  // 禁用拷贝和移动 - 环形缓冲区通常作为共享资源存在
-  ThreadSafeRingBuffer(const ThreadSafeRingBuffer&) = delete;
-  ThreadSafeRingBuffer& operator=(const ThreadSafeRingBuffer&) = delete;
-  ThreadSafeRingBuffer(ThreadSafeRingBuffer&&) = delete;
-  ThreadSafeRingBuffer& operator=(ThreadSafeRingBuffer&&) = delete;
+using ProcessFunction = std::function<uint64_t(const SimulatedImage&)>;
 
-  // =========================================================================
-  // Push - 阻塞式入队操作
-  // =========================================================================
-  // 知识点：为什么使用 std::unique_lock 而不是 std::lock_guard？
-  //
-  // std::lock_guard:
-  //   - 简单的 RAII 锁包装器
-  //   - 构造时加锁，析构时解锁
-  //   - 不能手动解锁/重新加锁
-  //
-  // std::unique_lock:
-  //   - 更灵活的锁包装器
-  //   - 支持手动 lock()/unlock()
-  //   - 支持与 condition_variable 配合使用
-  //   - condition_variable::wait() 会自动释放锁并等待
-  //
-  // 在 wait() 期间锁被释放，允许其他线程操作缓冲区
-  // 当被唤醒后，锁会自动重新获取
-  // =========================================================================
-  bool Push(T item, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
-    std::unique_lock<std::mutex> lock(mutex_);
+// 模拟负载：保持原有的 5-20ms 随机 sleep 行为
+class SleepWorkload {
+ public:
+  SleepWorkload(int min_ms = 5, int max_ms = 20)
+      : gen_(std::random_device{}()), dist_(min_ms, max_ms) {}
 
-    // 等待条件：缓冲区未满 或 已停止
-    auto predicate = [this]() { return count_ < Capacity || stopped_; };
+  uint64_t operator()(const SimulatedImage&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(dist_(gen_)));
+    return 0;
+  }
 
-    if (timeout == std::chrono::milliseconds::max()) {
-      not_full_cv_.wait(lock, predicate);
-    } else {
-      if (!not_full_cv_.wait_for(lock, timeout, predicate)) {
-        return false;  // 超时
-      }
-    }
+ private:
+  std::mt19937 gen_;
+  std::uniform_int_distribution<> dist_;
+};
 
-    if (stopped_) {
-      return false;  // 已停止，不再接受新数据
+// 真实负载1：RGB → 灰度（BT.601 整数近似：Y = (77R + 150G + 29B) >> 8）
+class GrayscaleWorkload {
+ public:
+  uint64_t operator()(const SimulatedImage& image) {
+    const size_t pixels = static_cast<size_t>(image.GetWidth()) *
+                          static_cast<size_t>(image.GetHeight());
+    gray_.resize(pixels);
+    const uint8_t* rgb = image.Data();
+    for (size_t i = 0; i < pixels; ++i) {
+      const uint8_t* p = rgb + i * SimulatedImage::kChannels;
+      gray_[i] = static_cast<uint8_t>((77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8);
     }
-
-    // 入队操作
-    buffer_[tail_] = std::move(item);
-    tail_ = (tail_ + 1) % Capacity;
-    ++count_;
-
-    // 通知等待的消费者
-    lock.unlock();  // 先解锁再通知，提高效率
-    not_empty_cv_.notify_one();
-
-    return true;
+    return pixels == 0 ? 0 : gray_[pixels / 2] + gray_[pixels - 1];
   }
 
-  // =========================================================================
-  // Pop - 阻塞式出队操作
-  // =========================================================================
-  // 返回 std::optional 的设计考量：
-  // 1. 当缓冲区被停止时，需要一种方式告知消费者"没有更多数据"
-  // 2. std::optional 完美表达"可能有值，也可能没有"的语义
-  // 3. 避免使用异常或错误码，代码更清晰
-  // =========================================================================
-  std::optional<T> Pop(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
-    std::unique_lock<std::mutex> lock(mutex_);
-
-    // 等待条件：缓冲区非空 或 已停止
-    auto predicate = [this]() { return count_ > 0 || stopped_; };
+ private:
+  std::vector<uint8_t> gray_;  // 复用输出缓冲，避免每帧分配
+};
 
-    if (timeout == std::chrono::milliseconds::max()) {
-      not_empty_cv_.wait(lock, predicate);
-    } else {
-      if (!not_empty_cv_.wait_for(lock, timeout, predicate)) {
-        return std::nullopt;  // 超时
+// 真实负载2：2x2 均值下采样（类似 Resize 到 1/2 分辨率）
+class DownscaleWorkload {
+ public:
+  uint64_t operator()(const SimulatedImage& image) {
+    constexpr int c = SimulatedImage::kChannels;
+    const int out_w = image.GetWidth() / 2;
+    const int out_h = image.GetHeight() / 2;
+    const size_t in_stride = static_cast<size_t>(image.GetWidth()) * c;
+    small_.resize(static_cast<size_t>(out_w) * static_cast<size_t>(out_h) * c);
+
+    const uint8_t* src = image.Data();
+    for (int y = 0; y < out_h; ++y) {
+      const uint8_t* row0 = src + static_cast<size_t>(2 * y) * in_stride;
+      const uint8_t* row1 = row0 + in_stride;
+      uint8_t* dst = small_.data() + static_cast<size_t>(y) * out_w * c;
+      for (int x = 0; x < out_w; ++x) {
+        for (int k = 0; k < c; ++k) {
+          int sum = row0[2 * x * c + k] + row0[(2 * x + 1) * c + k] +
+                    row1[2 * x * c + k] + row1[(2 * x + 1) * c + k];
+          dst[x * c + k] = static_cast<uint8_t>((sum + 2) >> 2);
+        }
       }
     }
-
-    // 即使已停止，如果还有数据也要消费完
-    if (count_ == 0) {
-      return std::nullopt;  // 已停止且无数据
-    }
-
-    // 出队操作
-    T item = std::move(buffer_[head_]);
-    head_ = (head_ + 1) % Capacity;
-    --count_;
-
-    // 通知等待的生产者
-    lock.unlock();
-    not_full_cv_.notify_one();
-
-    return item;
+    return small_.empty() ? 0 : small_.front() + small_.back();
   }
 
-  // =========================================================================
-  // Stop - 优雅停止机制
-  // =========================================================================
-  // 设计考量：
-  // 1. 停止后不再接受新数据
-  // 2. 允许消费者消费完剩余数据
-  // 3. 唤醒所有等待的线程，让它们有机会退出
-  // =========================================================================
-  void Stop() {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      stopped_ = true;
-    }
-    // 唤醒所有等待的线程
-    not_full_cv_.notify_all();
-    not_empty_cv_.notify_all();
-  }
-
-  // 重置缓冲区（用于测试）
-  void Reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    head_ = 0;
-    tail_ = 0;
-    count_ = 0;
-    stopped_ = false;
-  }
-
-  // 查询方法（用于调试和统计）
-  size_t Size() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return count_;
-  }
-
-  bool Empty() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return count_ == 0;
-  }
-
-  bool Full() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return count_ == Capacity;
-  }
+ private:
+  std::vector<uint8_t> small_;
+};
 
-  bool IsStopped() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stopped_;
+// 真实负载3：全帧校验和（纯内存带宽：4 路独立累加，打破依赖链）
+class ChecksumWorkload {
+ public:
+  uint64_t operator()(const SimulatedImage& image) {
+    const uint8_t* p = image.Data();
+    const size_t n = image.GetDataSize();
+    uint64_t acc[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+      for (int lane = 0; lane < 4; ++lane) {
+        uint64_t word;
+        std::memcpy(&word, p + i + lane * 8, sizeof(word));
+        acc[lane] += word;
+      }
+    }
+    for (; i < n; ++i) acc[0] += p[i];
+    return acc[0] ^ (acc[1] << 1) ^ (acc[2] << 2) ^ (acc[3] << 3);
   }
-
-  static constexpr size_t GetCapacity() { return Capacity; }
-
- private:
-  std::array<T, Capacity> buffer_;  // 环形缓冲区存储
-  size_t head_;                     // 出队位置
-  size_t tail_;                     // 入队位置
-  size_t count_;                    // 当前元素数量
-  bool stopped_;                    // 停止标志
-
-  mutable std::mutex mutex_;                // 互斥锁 (mutable 允许在 const 方法中使用)
-  std::condition_variable not_full_cv_;     // 缓冲区未满条件变量
-  std::condition_variable not_empty_cv_;    // 缓冲区非空条件变量
 };
 
 // =============================================================================
@@ -310,12 +272,14 @@ class ThreadSafeRingBuffer {
 // =============================================================================
 class ImageProducer {
  public:
-  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 16>;
+  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 16, ProfiledMutex>;
 
   ImageProducer(BufferType& buffer, int target_fps = 30)
       : buffer_(buffer),
         target_fps_(target_fps),
         produced_count_(0),
+        decimated_count_(0),
+        verbose_(true),
         running_(false) {}
 
   // 启动生产者线程
@@ -335,15 +299,45 @@ class ImageProducer {
   // 获取统计信息
   uint64_t GetProducedCount() const { return produced_count_; }
 
+  // 关闭逐帧日志（基准测试时避免日志锁干扰测量）
+  void SetVerbose(bool verbose) { verbose_ = verbose; }
+
+  // =========================================================================
+  // 准入控制（在 Start() 之前调用）
+  // =========================================================================
+  // kAdjustRate: 每帧根据消费速率和队列长度重新计算 target_fps_
+  // kDecimate:   按构造时的 target_fps 采集，控制器决定哪些帧入队
+  // =========================================================================
+  void EnableAdmissionControl(const AdmissionConfig& config) {
+    admission_.emplace(config);
+  }
+
+  uint64_t GetDecimatedCount() const { return decimated_count_; }
+  // 生产者线程每帧可能改写帧率，其他线程随时读取（relaxed 即可，只是一个数值）
+  double GetCurrentFps() const {
+    return target_fps_.load(std::memory_order_relaxed);
+  }
+
+  // 有效帧率随时间的记录（生产者线程结束后读取）
+  std::vector<RateSample> GetRateHistory() const {
+    return admission_ ? admission_->History() : std::vector<RateSample>{};
+  }
+
+  // 生产者线程的 CPU 时间与上下文切换（Join() 之后读取）
+  const ThreadCpuReport& GetCpuReport() const { return cpu_meter_.Report(); }
+
  private:
   void ProducerLoop(int total_frames) {
-    // 计算帧间隔
-    auto frame_interval =
-        std::chrono::milliseconds(1000 / target_fps_);
+    cpu_meter_.Begin();
+    decimated_count_ = 0;
+    if (admission_) {
+      admission_->Reset(std::chrono::steady_clock::now(),
+                        buffer_.GetPoppedCount());
+    }
 
     {
       std::ostringstream oss;
-      oss << "[Producer] Started, target FPS: " << target_fps_
+      oss << "[Producer] Started, target FPS: " << GetCurrentFps()
           << ", total frames: " << total_frames << "\n";
       ThreadSafeLog(oss.str());
     }
@@ -351,18 +345,42 @@ class ImageProducer {
     for (int i = 0; i < total_frames && running_; ++i) {
       auto start_time = std::chrono::steady_clock::now();
 
+      bool admit = true;
+      if (admission_) {
+        admission_->Update(start_time, buffer_.Size(),
+                           buffer_.GetPoppedCount());
+        if (admission_->Mode() == AdmissionMode::kAdjustRate) {
+          target_fps_.store(admission_->AdmittedFps(),
+                            std::memory_order_relaxed);
+        } else {
+          admit = admission_->Admit();
+        }
+      }
+
+      // 计算帧间隔（准入控制可能每帧改变 target_fps_）
+      auto frame_interval = std::chrono::microseconds(
+          static_cast<int64_t>(1e6 / GetCurrentFps()));
+
       // 创建模拟图像 (1920x1080 Full HD)
       SimulatedImage image(static_cast<uint64_t>(i + 1), 1920, 1080);
-
-      // 入队
-      if (buffer_.Push(std::move(image))) {
+      const uint64_t frame_id = image.GetId();
+      FlightRecorder* recorder = buffer_.GetFlightRecorder();
+      if (recorder) recorder->Record(FrameEvent::kCaptured, frame_id);
+
+      if (!admit) {
+        ++decimated_count_;  // 抽帧：采集了但不入队
+        if (recorder) recorder->Record(FrameEvent::kDecimated, frame_id);
+      } else if (buffer_.Push(std::move(image))) {
         ++produced_count_;
-        std::ostringstream oss;
-        oss << "[Producer] Frame " << (i + 1) << " produced, "
-            << "buffer size: " << buffer_.Size() << "/"
-            << buffer_.GetCapacity() << "\n";
-        ThreadSafeLog(oss.str());
+        if (verbose_) {
+          std::ostringstream oss;
+          oss << "[Producer] Frame " << (i + 1) << " produced, "
+              << "buffer size: " << buffer_.Size() << "/"
+              << buffer_.GetCapacity() << "\n";
+          ThreadSafeLog(oss.str());
+        }
       } else {
+        if (recorder) recorder->Record(FrameEvent::kPushFailed, frame_id);
         std::ostringstream oss;
         oss << "[Producer] Failed to push frame " << (i + 1)
             << " (buffer stopped)\n";
@@ -382,11 +400,16 @@ class ImageProducer {
       oss << "[Producer] Finished, total produced: " << produced_count_ << "\n";
       ThreadSafeLog(oss.str());
     }
+    cpu_meter_.End("producer", produced_count_ + decimated_count_);
   }
 
   BufferType& buffer_;
-  int target_fps_;
+  std::atomic<double> target_fps_;
   std::atomic<uint64_t> produced_count_;
+  std::atomic<uint64_t> decimated_count_;
+  bool verbose_;
+  std::optional<AdmissionController> admission_;
+  ThreadCpuMeter cpu_meter_;
   std::atomic<bool> running_;
   std::thread thread_;
 };
@@ -398,26 +421,29 @@ class ImageProducer {
 // =============================================================================
 class ImageConsumer {
  public:
-  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 16>;
+  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 16, ProfiledMutex>;
 
-  ImageConsumer(BufferType& buffer, int consumer_id)
+  // process 为每帧的处理函数，默认保持 5-20ms 随机 sleep 的模拟行为
+  ImageConsumer(BufferType& buffer, int consumer_id,
+                ProcessFunction process = SleepWorkload())
       : buffer_(buffer),
         consumer_id_(consumer_id),
+        process_(std::move(process)),
         consumed_count_(0),
         total_latency_ms_(0),
-        running_(false) {}
+        total_process_ms_(0),
+        digest_(0),
+        verbose_(true) {}
 
-  // 启动消费者线程
+  // 启动消费者线程；缓冲区 Close() 且取空后线程自行结束，无需单独停止
   void Start() {
-    running_ = true;
     consumed_count_ = 0;
     total_latency_ms_ = 0;
+    total_process_ms_ = 0;
+    digest_ = 0;
     thread_ = std::thread(&ImageConsumer::ConsumerLoop, this);
   }
 
-  // 停止消费者
-  void Stop() { running_ = false; }
-
   // 等待消费者线程结束
   void Join() {
     if (thread_.joinable()) {
@@ -433,50 +459,85 @@ class ImageConsumer {
     return total_latency_ms_ / static_cast<double>(consumed_count_);
   }
 
+  double GetAverageProcessMs() const {
+    if (consumed_count_ == 0) return 0.0;
+    return total_process_ms_ / static_cast<double>(consumed_count_);
+  }
+
+  // 处理函数返回值的累加（用于校验，并防止计算被优化掉）
+  uint64_t GetDigest() const { return digest_; }
+
+  // 关闭逐帧日志（基准测试时避免日志锁干扰测量）
+  void SetVerbose(bool verbose) { verbose_ = verbose; }
+
+  // 消费者线程的 CPU 时间与上下文切换（Join() 之后读取）
+  const ThreadCpuReport& GetCpuReport() const { return cpu_meter_.Report(); }
+
+  // 端到端延迟（采集 → 处理完成）超过 slo_ms 时，把缓冲区挂接的飞行记录仪
+  // 转储到 dump_path（同一记录仪两次转储至少间隔 1 秒）。在 Start() 之前调用。
+  void SetLatencySlo(double slo_ms, std::string dump_path) {
+    slo_ms_ = slo_ms;
+    slo_dump_path_ = std::move(dump_path);
+  }
+
+  uint64_t GetSloViolationCount() const { return slo_violations_; }
+
  private:
   void ConsumerLoop() {
+    cpu_meter_.Begin();
     {
       std::ostringstream oss;
       oss << "[Consumer " << consumer_id_ << "] Started\n";
       ThreadSafeLog(oss.str());
     }
 
-    // 用于模拟随机处理时间
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> process_time_dist(5, 20);  // 5-20ms
-
-    while (running_ || !buffer_.Empty()) {
-      // 尝试从队列获取图像，超时100ms
-      auto image = buffer_.Pop(std::chrono::milliseconds(100));
-
-      if (image.has_value()) {
-        auto start_process = std::chrono::steady_clock::now();
-
-        // 计算从采集到处理的延迟
-        auto current_time =
-            std::chrono::steady_clock::now().time_since_epoch().count();
-        double latency_ms =
-            static_cast<double>(current_time - image->GetTimestamp()) / 1e6;
-        total_latency_ms_ += latency_ms;
-
-        // 模拟图像处理（如 Resize, BGR2Gray 等）
-        int process_time = process_time_dist(gen);
-        std::this_thread::sleep_for(std::chrono::milliseconds(process_time));
-
-        ++consumed_count_;
+    // 取到流结束为止：Close() 之后剩余的帧仍会被处理，然后循环退出
+    FlightRecorder* recorder = buffer_.GetFlightRecorder();
+    for (SimulatedImage& image : buffer_) {
+      auto start_process = std::chrono::steady_clock::now();
+      if (recorder) recorder->Record(FrameEvent::kProcessBegin, image.GetId());
+
+      // 计算从采集到处理的延迟
+      auto current_time =
+          std::chrono::steady_clock::now().time_since_epoch().count();
+      double latency_ms =
+          static_cast<double>(current_time - image.GetTimestamp()) / 1e6;
+      total_latency_ms_ += latency_ms;
+
+      // 图像处理（如 Resize, BGR2Gray 等），由处理函数决定
+      digest_ += process_(image);
+
+      ++consumed_count_;
+
+      double e2e_ms =
+          static_cast<double>(
+              std::chrono::steady_clock::now().time_since_epoch().count() -
+              image.GetTimestamp()) /
+          1e6;
+      if (recorder) {
+        recorder->Record(FrameEvent::kProcessEnd, image.GetId(),
+                         static_cast<uint64_t>(e2e_ms * 1000.0));
+        if (slo_ms_ > 0.0 && e2e_ms > slo_ms_) {
+          ++slo_violations_;
+          recorder->DumpOnSloViolation(slo_dump_path_.c_str(), image.GetId(),
+                                       static_cast<uint64_t>(e2e_ms * 1000.0),
+                                       std::chrono::seconds(1));
+        }
+      }
 
-        auto process_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - start_process);
+      // 只读一次时钟：日志与统计使用同一段处理时间
+      const std::chrono::duration<double, std::milli> process_duration =
+          std::chrono::steady_clock::now() - start_process;
+      total_process_ms_ += process_duration.count();
 
-        std::ostringstream oss;
-        oss << "[Consumer " << consumer_id_ << "] Processed "
-            << image->ToString()
-            << ", latency: " << std::fixed << std::setprecision(2)
-            << latency_ms << "ms"
-            << ", process time: " << process_duration.count() << "ms\n";
-        ThreadSafeLog(oss.str());
-      }
+      if (!verbose_) continue;
+      std::ostringstream oss;
+      oss << "[Consumer " << consumer_id_ << "] Processed "
+          << image.ToString()
+          << ", latency: " << std::fixed << std::setprecision(2)
+          << latency_ms << "ms"
+          << ", process time: " << process_duration.count() << "ms\n";
+      ThreadSafeLog(oss.str());
     }
 
     std::ostringstream oss;
@@ -485,13 +546,21 @@ class ImageConsumer {
         << ", avg latency: " << std::fixed << std::setprecision(2)
         << GetAverageLatencyMs() << "ms\n";
     ThreadSafeLog(oss.str());
+    cpu_meter_.End("consumer-" + std::to_string(consumer_id_), consumed_count_);
   }
 
   BufferType& buffer_;
   int consumer_id_;
+  ProcessFunction process_;
   std::atomic<uint64_t> consumed_count_;
   double total_latency_ms_;
-  std::atomic<bool> running_;
+  double total_process_ms_;
+  uint64_t digest_;
+  bool verbose_;
+  double slo_ms_ = 0.0;  // 0 表示不检查
+  std::string slo_dump_path_;
+  std::atomic<uint64_t> slo_violations_{0};
+  ThreadCpuMeter cpu_meter_;
   std::thread thread_;
 };
 
@@ -505,7 +574,7 @@ void TestBasicFunctionality() {
   std::cout << "Test 1: Basic Ring Buffer Functionality\n";
   std::cout << std::string(60, '=') << "\n";
 
-  ThreadSafeRingBuffer<int, 4> buffer;
+  ThreadSafeRingBuffer<int, 4, ProfiledMutex> buffer("test1.buffer");
 
   // 测试入队
   std::cout << "Pushing 1, 2, 3...\n";
@@ -537,8 +606,8 @@ void TestProducerConsumer() {
   std::cout << "Test 2: Producer-Consumer Multi-threading\n";
   std::cout << std::string(60, '=') << "\n";
 
-  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 16>;
-  BufferType buffer;
+  using BufferType = ImageConsumer::BufferType;
+  BufferType buffer("test2.frame_buffer");
 
   // 创建1个生产者和2个消费者
   ImageProducer producer(buffer, 60);  // 60 FPS
@@ -555,13 +624,8 @@ void TestProducerConsumer() {
   // 等待生产者完成
   producer.Join();
 
-  // 等待一段时间让消费者处理完剩余数据
-  std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
-  // 停止缓冲区和消费者
-  buffer.Stop();
-  consumer1.Stop();
-  consumer2.Stop();
+  // 关闭通道：消费者取完剩余数据后自行退出，不需要 sleep 等待
+  buffer.Close();
 
   // 等待消费者完成
   consumer1.Join();
@@ -597,7 +661,7 @@ void TestHighConcurrency() {
   std::cout << "Test 3: High Concurrency Stress Test\n";
   std::cout << std::string(60, '=') << "\n";
 
-  ThreadSafeRingBuffer<int, 100> buffer;
+  ThreadSafeRingBuffer<int, 100, ProfiledMutex> buffer("test3.stress_buffer");
   std::atomic<int> push_count(0);
   std::atomic<int> pop_count(0);
   const int items_per_thread = 1000;
@@ -621,13 +685,9 @@ void TestHighConcurrency() {
   // 创建消费者线程
   for (int i = 0; i < num_consumers; ++i) {
     consumers.emplace_back([&buffer, &pop_count]() {
-      while (true) {
-        auto val = buffer.Pop(std::chrono::milliseconds(50));
-        if (val.has_value()) {
-          ++pop_count;
-        } else if (buffer.IsStopped()) {
-          break;
-        }
+      for (int& val : buffer) {
+        (void)val;
+        ++pop_count;
       }
     });
   }
@@ -637,13 +697,8 @@ void TestHighConcurrency() {
     t.join();
   }
 
-  // 等待所有数据被消费
-  while (!buffer.Empty()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
-
-  // 停止缓冲区
-  buffer.Stop();
+  // 关闭通道：剩余数据仍会被消费完
+  buffer.Close();
 
   // 等待所有消费者完成
   for (auto& t : consumers) {
@@ -668,7 +723,7 @@ void TestTimeout() {
   std::cout << "Test 4: Timeout Mechanism\n";
   std::cout << std::string(60, '=') << "\n";
 
-  ThreadSafeRingBuffer<int, 2> buffer;
+  ThreadSafeRingBuffer<int, 2, ProfiledMutex> buffer("test4.buffer");
 
   // 测试 Pop 超时（空缓冲区）
   auto start = std::chrono::steady_clock::now();
@@ -705,6 +760,924 @@ void TestTimeout() {
   }
 }
 
+// 测试5：真实 CPU 负载 vs sleep 模拟
+void TestRealWorkloads() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 5: Real CPU Workloads vs Sleep Simulation\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using BufferType = ImageConsumer::BufferType;
+  const int total_frames = 40;
+
+  struct Case {
+    const char* name;
+    std::function<ProcessFunction()> make;
+  };
+  const Case cases[] = {
+      {"sleep(5-20ms)", []() { return ProcessFunction(SleepWorkload()); }},
+      {"grayscale", []() { return ProcessFunction(GrayscaleWorkload()); }},
+      {"downscale 2x", []() { return ProcessFunction(DownscaleWorkload()); }},
+      {"checksum", []() { return ProcessFunction(ChecksumWorkload()); }},
+  };
+
+  bool all_ok = true;
+  for (const Case& c : cases) {
+    BufferType buffer("test5.frame_buffer");
+    ImageProducer producer(buffer, 1000);  // 不限速：测量消费端真实能力
+    ImageConsumer consumer1(buffer, 1, c.make());
+    ImageConsumer consumer2(buffer, 2, c.make());
+    producer.SetVerbose(false);
+    consumer1.SetVerbose(false);
+    consumer2.SetVerbose(false);
+
+    auto start = std::chrono::steady_clock::now();
+    consumer1.Start();
+    consumer2.Start();
+    producer.Start(total_frames);
+    producer.Join();
+
+    // 关闭后消费者仍会取完剩余数据，因此无需等待
+    buffer.Close();
+    consumer1.Join();
+    consumer2.Join();
+    double wall_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+
+    uint64_t consumed =
+        consumer1.GetConsumedCount() + consumer2.GetConsumedCount();
+    double avg_process_ms =
+        (consumer1.GetAverageProcessMs() + consumer2.GetAverageProcessMs()) /
+        2.0;
+    all_ok = all_ok && consumed == static_cast<uint64_t>(total_frames);
+
+    std::ostringstream oss;
+    oss << "  " << std::left << std::setw(15) << c.name << std::right
+        << std::fixed << std::setprecision(2) << "frames=" << consumed
+        << ", wall=" << wall_ms << "ms"
+        << ", throughput=" << consumed * 1000.0 / wall_ms << " FPS"
+        << ", avg process=" << avg_process_ms << "ms"
+        << ", digest=" << (consumer1.GetDigest() + consumer2.GetDigest())
+        << "\n";
+    std::cout << oss.str();
+  }
+
+  if (all_ok) {
+    std::cout << "[PASSED] Real workload test\n";
+  } else {
+    std::cout << "[FAILED] Real workload test\n";
+  }
+}
+
+// 在合成时间轴上驱动 AdmissionController（不依赖真实时钟，结果确定）：
+// 采集间隔固定（kAdjustRate 时取 1 / AdmittedFps），单个消费者处理时间固定
+struct SyntheticAdmissionResult {
+  uint64_t captured = 0;
+  uint64_t admitted = 0;        // 控制器放行的帧数（不论队列是否已满）
+  double effective_fps = 0.0;  // 后半段的准入帧率
+  size_t max_occupancy = 0;    // 后半段（收敛后）的最大队列长度
+  double min_admitted_fps = 0.0;
+};
+
+SyntheticAdmissionResult RunSyntheticAdmission(const AdmissionConfig& config,
+                                               double capture_fps,
+                                               double service_fps,
+                                               size_t capacity,
+                                               double duration_s) {
+  using Clock = AdmissionController::Clock;
+  auto At = [](double t) {
+    return Clock::time_point{} + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(t));
+  };
+
+  AdmissionController controller(config);
+  std::deque<double> queue;  // 每帧的入队时刻
+  uint64_t popped = 0;
+  double consumer_free_at = 0.0;
+  const double service_s = 1.0 / service_fps;
+  const double half = duration_s / 2.0;
+  uint64_t admitted_second_half = 0;
+
+  SyntheticAdmissionResult result;
+  result.min_admitted_fps = config.max_fps;
+  controller.Reset(At(0.0), 0);
+  for (double t = 0.0; t < duration_s;) {
+    // 消费者：取走所有在 t 之前就能开始处理的帧
+    while (!queue.empty() &&
+           std::max(consumer_free_at, queue.front()) <= t) {
+      consumer_free_at = std::max(consumer_free_at, queue.front()) + service_s;
+      queue.pop_front();
+      ++popped;
+    }
+
+    controller.Update(At(t), queue.size(), popped);
+    ++result.captured;
+    bool admit = config.mode == AdmissionMode::kAdjustRate || controller.Admit();
+    if (admit) {
+      ++result.admitted;
+      if (t >= half) ++admitted_second_half;
+      if (queue.size() < capacity) queue.push_back(t);  // 满了：放行后被丢弃
+    }
+    if (t >= half) {
+      result.max_occupancy = std::max(result.max_occupancy, queue.size());
+    }
+    result.min_admitted_fps =
+        std::min(result.min_admitted_fps, controller.AdmittedFps());
+
+    double fps = config.mode == AdmissionMode::kAdjustRate
+                     ? std::min(capture_fps, controller.AdmittedFps())
+                     : capture_fps;
+    t += 1.0 / fps;
+  }
+  result.effective_fps =
+      static_cast<double>(admitted_second_half) / (duration_s - half);
+  return result;
+}
+
+// 测试6：自适应准入控制 - 消费者跟不上时少采帧而不是积压旧帧
+// 第一部分在合成时间轴上校验控制律（确定性）；第二部分用真实线程运行，
+// 只校验与调度无关的不变量（帧不丢失、准入帧率不低于 min_fps）
+void TestAdmissionControl() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 6: Adaptive Producer Admission Control\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using BufferType = ImageConsumer::BufferType;
+  const int total_frames = 100;
+  const int capture_fps = 200;  // 单个消费者约 100 FPS，生产者明显更快
+  const size_t capacity = BufferType::GetCapacity();
+
+  AdmissionConfig config;
+  config.min_fps = 10.0;
+  config.max_fps = capture_fps;
+  config.target_occupancy = 2.0;
+
+  bool all_ok = true;
+
+  // ---- 合成时间轴：控制律 ----
+  struct SyntheticCase {
+    const char* name;
+    AdmissionMode mode;
+    double capture_fps;
+    double service_fps;
+    double expect_fps;  // 收敛后的期望准入帧率
+  };
+  const SyntheticCase synthetic_cases[] = {
+      // 消费者较慢：准入帧率收敛到服务速率，队列稳定在目标附近
+      {"decimate, slow consumer", AdmissionMode::kDecimate, 200.0, 100.0, 100.0},
+      {"adjust, slow consumer", AdmissionMode::kAdjustRate, 200.0, 100.0, 100.0},
+      // 采集本身就慢（例如 -O0 下构造大图）：消费者在等帧，不能越抽越少
+      {"decimate, slow capture", AdmissionMode::kDecimate, 40.0, 100.0, 40.0},
+      // 消费者比 min_fps 还慢：准入帧率被夹在 min_fps，队列由容量兜底
+      {"decimate, overload", AdmissionMode::kDecimate, 200.0, 5.0, 10.0},
+  };
+  std::cout << "Synthetic clock (10 s each):\n";
+  for (const SyntheticCase& c : synthetic_cases) {
+    AdmissionConfig case_config = config;
+    case_config.mode = c.mode;
+    SyntheticAdmissionResult r = RunSyntheticAdmission(
+        case_config, c.capture_fps, c.service_fps, capacity, 10.0);
+
+    bool rate_ok = std::abs(r.effective_fps - c.expect_fps) <=
+                   0.1 * c.expect_fps;
+    bool min_ok = r.min_admitted_fps >= config.min_fps &&
+                  r.effective_fps >= 0.95 * std::min(config.min_fps,
+                                                     c.capture_fps);
+    // 消费者跟得上时，队列不超过目标占用的两倍（+1 帧的采样抖动）
+    size_t occupancy_bound =
+        c.service_fps >= config.min_fps
+            ? static_cast<size_t>(2.0 * config.target_occupancy) + 1
+            : capacity;
+    bool occupancy_ok = r.max_occupancy <= occupancy_bound;
+
+    std::cout << "  " << std::left << std::setw(24) << c.name << std::right
+              << std::fixed << std::setprecision(1) << "capture="
+              << c.capture_fps << ", service=" << c.service_fps
+              << ", effective=" << r.effective_fps
+              << " FPS, max occupancy=" << r.max_occupancy << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    all_ok = all_ok && rate_ok && min_ok && occupancy_ok;
+  }
+
+  // ---- 真实线程：不变量 ----
+  struct Case {
+    const char* name;
+    bool enabled;
+    AdmissionMode mode;
+  };
+  const Case cases[] = {
+      {"no control", false, AdmissionMode::kAdjustRate},
+      {"adjust rate", true, AdmissionMode::kAdjustRate},
+      {"decimate", true, AdmissionMode::kDecimate},
+  };
+
+  std::cout << "Real threads:\n";
+  for (const Case& c : cases) {
+    BufferType buffer("test6.frame_buffer");
+    ImageProducer producer(buffer, capture_fps);
+    ImageConsumer consumer(buffer, 1, SleepWorkload(8, 12));
+    producer.SetVerbose(false);
+    consumer.SetVerbose(false);
+    if (c.enabled) {
+      config.mode = c.mode;
+      producer.EnableAdmissionControl(config);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    consumer.Start();
+    producer.Start(total_frames);
+    producer.Join();
+    buffer.Close();
+    consumer.Join();
+    double wall_s = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+
+    double latency = consumer.GetAverageLatencyMs();
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << "  " << std::left
+        << std::setw(12) << c.name << std::right
+        << "pushed=" << producer.GetProducedCount()
+        << ", decimated=" << producer.GetDecimatedCount()
+        << ", consumed=" << consumer.GetConsumedCount()
+        << ", effective FPS=" << producer.GetProducedCount() / wall_s
+        << ", avg latency=" << latency << "ms\n";
+
+    // 有效帧率时间线（每 ~250ms 打印一个采样点）
+    bool rates_ok = true;
+    double next_print = 0.0;
+    for (const RateSample& sample : producer.GetRateHistory()) {
+      // 抽帧后的准入帧率 = min(admitted, 实测采集帧率)，不得低于 min_fps
+      double effective = std::min(sample.admitted_fps, sample.capture_fps);
+      rates_ok = rates_ok && sample.admitted_fps >= config.min_fps &&
+                 effective >= std::min(config.min_fps, sample.capture_fps) &&
+                 sample.occupancy <= capacity;
+      if (sample.time_s < next_print) continue;
+      next_print = sample.time_s + 0.25;
+      oss << "      t=" << std::setprecision(2) << sample.time_s
+          << "s admitted=" << std::setprecision(1) << sample.admitted_fps
+          << " FPS, capture=" << sample.capture_fps
+          << " FPS, service=" << sample.service_fps
+          << " FPS, occupancy=" << sample.occupancy << "\n";
+    }
+    std::cout << oss.str();
+
+    all_ok = all_ok && rates_ok &&
+             consumer.GetConsumedCount() == producer.GetProducedCount() &&
+             producer.GetProducedCount() + producer.GetDecimatedCount() ==
+                 static_cast<uint64_t>(total_frames);
+  }
+
+  if (all_ok) {
+    std::cout << "[PASSED] Admission control test\n";
+  } else {
+    std::cout << "[FAILED] Admission control test\n";
+  }
+}
+
+// 测试7：广播环形缓冲区 - 一帧交给检测 / 录像 / 缩略图三个订阅者
+// 慢订阅者由测试线程驱动：读出第 1 帧后一直持有、不再读取，
+// 发布者与快订阅者逐帧同步，因此跳帧过程与调度无关：
+//   帧 2-8 填满 8 个槽 → 发布帧 9 时第 1 帧被摘下（detach）交给持有者
+//   → 发布帧 10 时慢订阅者被跳到最新（lag 1，跳过 2-9）
+//   → 帧 10-17 再次填满，发布帧 18 时 lag 2（跳过 10-17）→ 剩 18-20 未读
+void TestBroadcastFanOut() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 7: Broadcast Fan-Out Without Per-Subscriber Copies\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using RingType = BroadcastRing<SimulatedImage, 8>;
+  const int total_frames = 20;
+  RingType ring(BroadcastOverflow::kSkipLagging, std::chrono::milliseconds(5));
+
+  // 记录每个订阅者看到的像素地址：相同帧地址相同 → 没有拷贝
+  ProfiledMutex address_mutex("test7.address_mutex");
+  std::map<uint64_t, const uint8_t*> first_address;
+  std::atomic<int> address_mismatch(0);
+  auto CheckAddress = [&](const SimulatedImage& image) {
+    std::lock_guard<ProfiledMutex> lock(address_mutex);
+    auto [it, inserted] = first_address.emplace(image.GetId(), image.Data());
+    if (!inserted && it->second != image.Data()) ++address_mismatch;
+  };
+
+  struct Subscriber {
+    const char* name;
+    ProcessFunction process;
+    RingType::SubscriberId id;
+    uint64_t digest;
+  };
+  std::vector<Subscriber> subscribers = {
+      {"detector", ChecksumWorkload(), ring.Subscribe(), 0},
+      {"recorder", [](const SimulatedImage&) { return uint64_t{0}; },
+       ring.Subscribe(), 0},
+      {"thumbnailer", DownscaleWorkload(), ring.Subscribe(), 0},
+  };
+  RingType::SubscriberId slow_id = ring.Subscribe();
+
+  // 快订阅者每处理完（并释放）一帧就计数，发布者据此逐帧同步
+  std::mutex done_mutex;
+  std::condition_variable done_cv;
+  uint64_t frames_done = 0;
+
+  std::vector<std::thread> threads;
+  for (Subscriber& sub : subscribers) {
+    threads.emplace_back([&, sub_ptr = &sub]() {
+      while (true) {
+        {
+          auto frame = ring.Next(sub_ptr->id);
+          if (!frame) break;
+          const SimulatedImage& image = **frame;  // 槽中的原始帧，无拷贝
+          CheckAddress(image);
+          sub_ptr->digest += sub_ptr->process(image);
+        }  // FrameRef 析构：释放对槽的占用
+        {
+          std::lock_guard<std::mutex> lock(done_mutex);
+          ++frames_done;
+        }
+        done_cv.notify_all();
+      }
+    });
+  }
+
+  // 慢订阅者：读出第 1 帧并一直持有
+  ring.Publish(SimulatedImage(1, 1920, 1080));
+  std::optional<RingType::FrameRef> held = ring.Next(slow_id);
+  CheckAddress(**held);
+  const uint8_t* held_pixels = (*held)->Data();
+
+  size_t max_detached = 0;
+  for (int i = 1; i <= total_frames; ++i) {
+    if (i > 1) ring.Publish(SimulatedImage(static_cast<uint64_t>(i), 1920, 1080));
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&]() {
+      return frames_done == subscribers.size() * static_cast<uint64_t>(i);
+    });
+    max_detached = std::max(max_detached, ring.DetachedCount());
+  }
+
+  // 摘下的帧仍是原来的对象：地址不变，释放后才真正归还
+  bool held_intact = (*held)->GetId() == 1 && (*held)->Data() == held_pixels;
+  held.reset();
+  size_t detached_after_release = ring.DetachedCount();
+
+  // 慢订阅者读完剩余帧
+  ring.Stop();
+  while (auto frame = ring.Next(slow_id)) CheckAddress(**frame);
+  for (auto& t : threads) t.join();
+
+  bool fast_got_all = true;
+  for (const Subscriber& sub : subscribers) {
+    auto stats = ring.GetStats(sub.id);
+    std::cout << "  " << std::left << std::setw(16) << sub.name << std::right
+              << "received=" << stats.received << ", skipped=" << stats.skipped
+              << ", lag events=" << stats.lag_events << "\n";
+    fast_got_all = fast_got_all &&
+                   stats.received == static_cast<uint64_t>(total_frames) &&
+                   stats.skipped == 0 && stats.lag_events == 0;
+  }
+  auto slow = ring.GetStats(slow_id);
+  std::cout << "  " << std::left << std::setw(16) << "slow-analytics"
+            << std::right << "received=" << slow.received
+            << ", skipped=" << slow.skipped
+            << ", lag events=" << slow.lag_events << "\n";
+  std::cout << "  Detached while held: " << max_detached
+            << ", after release: " << detached_after_release
+            << ", held frame intact: " << held_intact << "\n";
+  std::cout << "  Pixel address mismatches across subscribers: "
+            << address_mismatch << "\n";
+
+  if (fast_got_all && address_mismatch == 0 && max_detached == 1 &&
+      detached_after_release == 0 && held_intact && slow.lag_events == 2 &&
+      slow.skipped == 16 && slow.received == 4) {
+    std::cout << "[PASSED] Broadcast fan-out test\n";
+  } else {
+    std::cout << "[FAILED] Broadcast fan-out test\n";
+  }
+}
+
+// 测试8：单个 epoll 线程同时等待两个帧队列和一个定时器
+void TestEpollReadiness() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 8: eventfd Readiness in an epoll Event Loop\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using BufferType = ThreadSafeRingBuffer<SimulatedImage, 8, ProfiledMutex>;
+  const int frames_per_queue = 50;
+  BufferType queues[2] = {BufferType("test8.steady_queue"),
+                          BufferType("test8.bursty_queue")};
+
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  itimerspec period{};
+  period.it_interval.tv_nsec = 20 * 1000 * 1000;  // 20ms 心跳
+  period.it_value = period.it_interval;
+  timerfd_settime(timer_fd, 0, &period, nullptr);
+
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.u32 = 2;  // 0、1 是队列，2 是定时器
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+  for (uint32_t i = 0; i < 2; ++i) {
+    ev.events = EPOLLIN | EPOLLET;  // 边沿触发：只在空 → 非空时醒来
+    ev.data.u32 = i;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, queues[i].EnableReadinessFd(), &ev);
+  }
+
+  // 两个"摄像头"：一个匀速，一个突发（每次连推 5 帧）
+  std::thread steady_camera([&queues]() {
+    for (int i = 0; i < frames_per_queue; ++i) {
+      queues[0].Push(SimulatedImage(static_cast<uint64_t>(i), 64, 48));
+      std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    }
+    queues[0].Close();
+  });
+  std::thread bursty_camera([&queues]() {
+    for (int i = 0; i < frames_per_queue; ++i) {
+      queues[1].Push(SimulatedImage(static_cast<uint64_t>(i), 64, 48));
+      if (i % 5 == 4) std::this_thread::sleep_for(std::chrono::milliseconds(15));
+    }
+    queues[1].Close();
+  });
+
+  uint64_t received[2] = {0, 0};
+  uint64_t queue_wakeups = 0;
+  uint64_t timer_ticks = 0;
+  bool in_order = true;
+  int open_queues = 2;
+  while (open_queues > 0) {
+    epoll_event events[4];
+    int n = epoll_wait(epoll_fd, events, 4, 1000);
+    if (n <= 0) break;  // 1 秒内没有任何事件：视为丢失唤醒
+    for (int k = 0; k < n; ++k) {
+      uint32_t tag = events[k].data.u32;
+      if (tag == 2) {
+        uint64_t expirations = 0;
+        if (read(timer_fd, &expirations, sizeof(expirations)) > 0) {
+          timer_ticks += expirations;
+        }
+        continue;
+      }
+      ++queue_wakeups;
+      BufferType& queue = queues[tag];
+      // 边沿触发：必须取空
+      while (auto frame = queue.TryPop()) {
+        in_order = in_order && frame->GetId() == received[tag];
+        ++received[tag];
+      }
+      if (queue.IsClosed() && queue.Empty()) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, queue.ReadinessFd(), nullptr);
+        --open_queues;
+      }
+    }
+  }
+  steady_camera.join();
+  bursty_camera.join();
+  close(timer_fd);
+  close(epoll_fd);
+
+  bool all_ok = open_queues == 0 && in_order && timer_ticks > 0;
+  const char* names[2] = {"steady", "bursty"};
+  for (int i = 0; i < 2; ++i) {
+    uint64_t signals = queues[i].GetReadinessSignalCount();
+    std::cout << "  " << std::left << std::setw(8) << names[i] << std::right
+              << "received=" << received[i] << ", eventfd signals=" << signals
+              << " (pushes=" << frames_per_queue << ")\n";
+    all_ok = all_ok && received[i] == static_cast<uint64_t>(frames_per_queue) &&
+             signals <= static_cast<uint64_t>(frames_per_queue) + 1;
+  }
+  std::cout << "  queue wakeups=" << queue_wakeups
+            << ", timer ticks=" << timer_ticks << "\n";
+
+  if (all_ok) {
+    std::cout << "[PASSED] epoll readiness test\n";
+  } else {
+    std::cout << "[FAILED] epoll readiness test\n";
+  }
+}
+
+// 测试9：Close() 语义 - 取完剩余数据、明确的流结束、微秒级关闭延迟
+void TestCloseSemantics() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 9: Close() Drain-Until-Empty and Shutdown Latency\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using Clock = std::chrono::steady_clock;
+  ThreadSafeRingBuffer<int, 16, ProfiledMutex> buffer("test9.buffer");
+  const int num_consumers = 4;
+  const int backlog = 10;
+
+  // 关闭前留下一批未消费的数据，消费者稍后才启动
+  for (int i = 0; i < backlog; ++i) buffer.Push(i);
+  buffer.Close();
+
+  // 关闭后生产者立即失败（不等待超时）
+  auto push_start = Clock::now();
+  bool push_after_close = buffer.Push(99, std::chrono::milliseconds(1000));
+  double push_us = std::chrono::duration<double, std::micro>(
+                       Clock::now() - push_start)
+                       .count();
+
+  std::atomic<int> drained(0);
+  std::vector<std::thread> drainers;
+  for (int c = 0; c < num_consumers; ++c) {
+    drainers.emplace_back([&buffer, &drained]() {
+      for (int& value : buffer) {
+        (void)value;
+        ++drained;
+      }
+    });
+  }
+  for (auto& t : drainers) t.join();
+
+  // 关闭延迟：消费者都阻塞在空队列上，测量从 Close() 到全部线程退出
+  ThreadSafeRingBuffer<int, 16, ProfiledMutex> idle("test9.idle_buffer");
+  std::atomic<int> waiting(0);
+  std::vector<std::thread> sleepers;
+  for (int c = 0; c < num_consumers; ++c) {
+    sleepers.emplace_back([&idle, &waiting]() {
+      ++waiting;
+      for (int& value : idle) (void)value;
+    });
+  }
+  while (waiting < num_consumers) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));  // 确保都已阻塞
+
+  auto close_start = Clock::now();
+  idle.Close();
+  for (auto& t : sleepers) t.join();
+  double close_us = std::chrono::duration<double, std::micro>(
+                        Clock::now() - close_start)
+                        .count();
+
+  std::cout << "  Push after Close: success=" << push_after_close << " in "
+            << std::fixed << std::setprecision(1) << push_us << "us\n";
+  std::cout << "  Drained after Close: " << drained << "/" << backlog << "\n";
+  std::cout << "  " << num_consumers << " blocked consumers exited " << close_us
+            << "us after Close() (previously up to one 100ms Pop timeout)\n";
+  std::cout.unsetf(std::ios::fixed);
+
+  if (!push_after_close && push_us < 1000.0 && drained == backlog &&
+      close_us < 10000.0) {
+    std::cout << "[PASSED] Close semantics test\n";
+  } else {
+    std::cout << "[FAILED] Close semantics test\n";
+  }
+}
+
+// 测试10：线程 CPU 时间 - 区分计算受限与等待受限的阶段
+void TestThreadCpuAccounting() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 10: Per-Thread CPU Time and Context Switches\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  using BufferType = ImageConsumer::BufferType;
+  const int total_frames = 30;
+
+  struct Case {
+    const char* name;
+    ProcessFunction (*make)();
+  };
+  const Case cases[] = {
+      {"sleep(5-20ms)", []() { return ProcessFunction(SleepWorkload()); }},
+      {"grayscale", []() { return ProcessFunction(GrayscaleWorkload()); }},
+  };
+
+  double consumer_util[2] = {0.0, 0.0};
+  for (int c = 0; c < 2; ++c) {
+    BufferType buffer("test10.frame_buffer");
+    ImageProducer producer(buffer, 60);
+    ImageConsumer consumer1(buffer, 1, cases[c].make());
+    ImageConsumer consumer2(buffer, 2, cases[c].make());
+    producer.SetVerbose(false);
+    consumer1.SetVerbose(false);
+    consumer2.SetVerbose(false);
+
+    consumer1.Start();
+    consumer2.Start();
+    producer.Start(total_frames);
+    producer.Join();
+    buffer.Close();
+    consumer1.Join();
+    consumer2.Join();
+
+    std::cout << "  workload: " << cases[c].name << "\n";
+    PrintCpuReport(std::cout, {producer.GetCpuReport(), consumer1.GetCpuReport(),
+                               consumer2.GetCpuReport()});
+    consumer_util[c] = (consumer1.GetCpuReport().Utilization() +
+                        consumer2.GetCpuReport().Utilization()) /
+                       2.0;
+  }
+
+  // sleep 负载几乎不占 CPU（等待受限），灰度转换应明显更"忙"
+  std::cout << "  avg consumer utilization: sleep=" << std::fixed
+            << std::setprecision(1) << consumer_util[0] * 100.0
+            << "%, grayscale=" << consumer_util[1] * 100.0 << "%\n";
+  std::cout.unsetf(std::ios::fixed);
+
+  if (consumer_util[1] > consumer_util[0]) {
+    std::cout << "[PASSED] Thread CPU accounting test\n";
+  } else {
+    std::cout << "[FAILED] Thread CPU accounting test\n";
+  }
+}
+
+// 测试11：飞行记录仪 - SIGUSR1 与 SLO 违例时转储，离线还原每帧时间线
+void TestFlightRecorder() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 11: Always-On Flight Recorder\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  const std::string signal_path = "/tmp/w4_flight_signal.w4rec";
+  const std::string slo_path = "/tmp/w4_flight_slo.w4rec";
+  std::remove(signal_path.c_str());
+  std::remove(slo_path.c_str());
+
+  FlightRecorder recorder(4096);
+  InstallFlightRecorderSignal(&recorder, signal_path.c_str());
+
+  using BufferType = ImageConsumer::BufferType;
+  BufferType buffer("test11.frame_buffer");
+  buffer.AttachFlightRecorder(&recorder);
+
+  // 120 FPS 输入、单个 5-20ms 消费者（约 80 FPS）：队列必然积压
+  const int total_frames = 40;
+  ImageProducer producer(buffer, 120);
+  ImageConsumer consumer(buffer, 1);
+  producer.SetVerbose(false);
+  consumer.SetVerbose(false);
+  consumer.SetLatencySlo(40.0, slo_path);
+
+  consumer.Start();
+  producer.Start(total_frames);
+  producer.Join();
+  buffer.Close();
+  consumer.Join();
+
+  // 模拟现场 kill -USR1 <pid>
+  std::raise(SIGUSR1);
+  InstallFlightRecorderSignal(nullptr, nullptr);
+
+  auto signal_dump = LoadFlightDump(signal_path);
+  auto slo_dump = LoadFlightDump(slo_path);
+  uint64_t violations = consumer.GetSloViolationCount();
+
+  // 每一帧都应按 captured → enqueued → dequeued → process-begin → process-end 出现
+  bool timelines_ok = signal_dump.has_value();
+  size_t complete_frames = 0;
+  if (signal_dump) {
+    for (const auto& [id, events] : GroupByFrame(signal_dump->events)) {
+      std::vector<FrameEvent> order;
+      for (const FlightEvent& e : events) {
+        if (e.event != FrameEvent::kSloViolation) order.push_back(e.event);
+      }
+      const std::vector<FrameEvent> expected = {
+          FrameEvent::kCaptured, FrameEvent::kEnqueued, FrameEvent::kDequeued,
+          FrameEvent::kProcessBegin, FrameEvent::kProcessEnd};
+      if (order == expected) {
+        ++complete_frames;
+      } else {
+        timelines_ok = false;
+      }
+    }
+    std::cout << "  SIGUSR1 dump: " << signal_dump->events.size()
+              << " events, torn=" << signal_dump->torn
+              << ", complete frame timelines=" << complete_frames << "/"
+              << total_frames << "\n";
+    std::cout << "  Last 2 frames (same output as ./flight_recorder_decode "
+              << signal_path << " 2):\n";
+    PrintFlightTimeline(std::cout, *signal_dump, 2);
+  }
+
+  // 构造一条撕裂记录：把最新一条记录的 seq_end 改成不同的值（模拟转储时
+  // 该槽正被下一轮写入），解码器必须丢弃它而不是解出混合的内容
+  bool torn_detected = false;
+  if (signal_dump && !signal_dump->events.empty()) {
+    const std::string torn_path = "/tmp/w4_flight_torn.w4rec";
+    std::ifstream in(signal_path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),
+                      std::istreambuf_iterator<char>());
+    const uint64_t newest = signal_dump->events.back().seq;
+    const size_t offset =
+        sizeof(FlightDumpHeader) +
+        (newest & (signal_dump->header.capacity - 1)) * sizeof(FlightRecordWords) +
+        offsetof(FlightRecordWords, seq_end);
+    uint64_t next_round = newest + 1 + signal_dump->header.capacity;
+    std::memcpy(&bytes[offset], &next_round, sizeof(next_round));
+    std::ofstream(torn_path, std::ios::binary) << bytes;
+
+    auto torn_dump = LoadFlightDump(torn_path);
+    torn_detected = torn_dump.has_value() &&
+                    torn_dump->torn == signal_dump->torn + 1 &&
+                    torn_dump->events.size() + 1 == signal_dump->events.size();
+    std::remove(torn_path.c_str());
+  }
+  std::cout << "  Torn record (seq != seq_end) rejected: " << torn_detected
+            << "\n";
+  std::cout << "  SLO(40ms) violations=" << violations << ", SLO dump "
+            << (slo_dump ? "written (reason: " +
+                               std::string(FlightDumpReasonName(
+                                   slo_dump->header.reason)) +
+                               ")"
+                         : std::string("not written"))
+            << "\n";
+
+  if (timelines_ok && complete_frames == static_cast<size_t>(total_frames) &&
+      torn_detected && violations > 0 && slo_dump.has_value()) {
+    std::cout << "[PASSED] Flight recorder test\n";
+  } else {
+    std::cout << "[FAILED] Flight recorder test\n";
+  }
+}
+
+// =============================================================================
+// 测试12：队列容量自动调优
+// =============================================================================
+// 用飞行记录仪测一段真实流水线的到达率和处理时间分布，
+// 再用经验分布仿真搜索满足丢帧率 / p99 目标的最小容量，与当前的 16 对比。
+// =============================================================================
+void TestCapacityTuner() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 12: Queue Capacity Auto-Tuner\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  const std::string dump_path = "/tmp/w4_capacity_profile.w4rec";
+  const int num_consumers = 1;
+  const int total_frames = 90;
+
+  FlightRecorder recorder(4096);
+  using BufferType = ImageConsumer::BufferType;
+  BufferType buffer("test12.frame_buffer");
+  buffer.AttachFlightRecorder(&recorder);
+
+  ImageProducer producer(buffer, 60);
+  ImageConsumer consumer(buffer, num_consumers);
+  producer.SetVerbose(false);
+  consumer.SetVerbose(false);
+
+  consumer.Start();
+  producer.Start(total_frames);
+  producer.Join();
+  buffer.Close();
+  consumer.Join();
+
+  recorder.DumpToFile(dump_path.c_str());
+  auto dump = LoadFlightDump(dump_path);
+  if (!dump) {
+    std::cout << "[FAILED] Capacity tuner test (no profile dump)\n";
+    return;
+  }
+
+  WorkloadProfile profile = ProfileFromFlightDump(*dump, num_consumers);
+  TuningTarget target;
+  target.max_drop_rate = 0.01;
+  target.max_p99_ms = 100.0;
+  CapacityRecommendation rec = RecommendCapacity(profile, target);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "  Measured: arrival=" << profile.arrival_fps
+            << " fps, mean service=" << profile.MeanServiceMs() << " ms ("
+            << profile.service_ms.size() << " samples, "
+            << profile.interarrival_ms.size()
+            << " inter-arrival samples), consumers="
+            << num_consumers << ", rho=" << rec.utilization << "\n";
+  std::cout << "  Little's law (lambda x " << target.max_p99_ms
+            << "ms) = " << rec.littles_law_bound
+            << " frames in flight on average, measured burst within "
+            << target.max_p99_ms << "ms = " << rec.burst_bound
+            << " frames (search bound)\n";
+  std::cout << "  " << std::setw(10) << "capacity" << std::setw(10) << "drop%"
+            << std::setw(12) << "p99(ms)" << std::setw(10) << "avg_occ" << "\n";
+  for (const auto& [capacity, report] : rec.candidates) {
+    std::cout << "  " << std::setw(10) << capacity << std::setw(10)
+              << report.DropRate() * 100.0 << std::setw(12) << report.p99_e2e_ms
+              << std::setw(10) << report.avg_occupancy << "\n";
+  }
+
+  const size_t current = BufferType::GetCapacity();
+  const double frame_mb = 1920.0 * 1080.0 * SimulatedImage::kChannels / 1e6;
+  std::cout << "  Recommendation: capacity " << rec.capacity << " ("
+            << rec.reason << "), current " << current << " -> saves "
+            << static_cast<double>(current - std::min(current, rec.capacity)) * frame_mb
+            << " MB of 1080p slots\n";
+  std::cout.unsetf(std::ios::fixed);
+
+  if (rec.feasible && rec.capacity >= 1 && rec.capacity <= current &&
+      rec.report.DropRate() <= target.max_drop_rate &&
+      rec.report.p99_e2e_ms <= target.max_p99_ms) {
+    std::cout << "[PASSED] Capacity tuner test\n";
+  } else {
+    std::cout << "[FAILED] Capacity tuner test\n";
+  }
+}
+
+// =============================================================================
+// 测试13：运行时容量的环形缓冲区
+// =============================================================================
+// 1. 容量取整到 2 的幂，0 被拒绝
+// 2. 队列深度来自环境变量 W4_QUEUE_DEPTH（模拟配置文件），多生产者多消费者不丢不重
+// 3. 下标计算：运行时 % vs 掩码
+// =============================================================================
+void TestDynamicRingBuffer() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 13: Runtime-Capacity Ring Buffer\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  bool rounding_ok = RoundUpPowerOfTwo(1) == 1 && RoundUpPowerOfTwo(5) == 8 &&
+                     RoundUpPowerOfTwo(16) == 16 && RoundUpPowerOfTwo(17) == 32;
+  try {
+    DynamicRingBuffer<int> invalid(0);
+    rounding_ok = false;
+  } catch (const std::invalid_argument&) {
+  }
+
+  // 配置无效（非数字、0、超出范围）时回退到默认深度，而不是让构造函数抛异常终止进程
+  constexpr size_t kDefaultDepth = 12;
+  constexpr unsigned long long kMaxDepth = 1u << 20;
+  size_t depth = kDefaultDepth;
+  if (const char* env_depth = std::getenv("W4_QUEUE_DEPTH")) {
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long parsed = std::strtoull(env_depth, &end, 10);
+    if (end != env_depth && *end == '\0' && errno == 0 && env_depth[0] != '-' &&
+        parsed >= 1 && parsed <= kMaxDepth) {
+      depth = static_cast<size_t>(parsed);
+    } else {
+      std::cout << "  Invalid W4_QUEUE_DEPTH \"" << env_depth
+                << "\" (expected 1.." << kMaxDepth << "), using default "
+                << kDefaultDepth << "\n";
+    }
+  }
+  DynamicRingBuffer<uint64_t, ProfiledMutex> buffer(depth, "test13.dynamic_buffer");
+  std::cout << "  Requested depth " << depth << " -> capacity "
+            << buffer.GetCapacity() << "\n";
+
+  // 2 生产者 × 20000 项；高 32 位为生产者编号，检查每个生产者的顺序和总和
+  const uint64_t per_producer = 20000;
+  std::vector<std::thread> producers;
+  for (uint64_t p = 0; p < 2; ++p) {
+    producers.emplace_back([&buffer, p, per_producer]() {
+      for (uint64_t i = 0; i < per_producer; ++i) buffer.Push((p << 32) | i);
+    });
+  }
+  std::atomic<uint64_t> sum(0);
+  std::atomic<bool> ordered(true);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < 2; ++c) {
+    consumers.emplace_back([&]() {
+      uint64_t local_sum = 0;
+      int64_t last_seen[2] = {-1, -1};
+      for (uint64_t item : buffer) {
+        uint64_t producer = item >> 32;
+        auto seq = static_cast<int64_t>(item & 0xFFFFFFFFu);
+        if (seq <= last_seen[producer]) ordered = false;
+        last_seen[producer] = seq;
+        local_sum += item & 0xFFFFFFFFu;
+      }
+      sum += local_sum;
+    });
+  }
+  for (auto& t : producers) t.join();
+  buffer.Close();
+  for (auto& t : consumers) t.join();
+
+  const uint64_t expected_sum = 2 * (per_producer * (per_producer - 1) / 2);
+  const bool transfer_ok = sum == expected_sum && ordered &&
+                           buffer.GetPoppedCount() == 2 * per_producer &&
+                           buffer.GetPushedCount() == 2 * per_producer;
+  std::cout << "  Transferred " << buffer.GetPoppedCount() << " items, sum "
+            << (sum == expected_sum ? "matches" : "MISMATCH") << ", per-producer order "
+            << (ordered ? "kept" : "BROKEN") << "\n";
+
+  // 下标计算对比：容量来自运行时（volatile 防止编译器把它当常量）
+  volatile size_t runtime_capacity = buffer.GetCapacity();
+  const size_t capacity = runtime_capacity;
+  const uint64_t mask = capacity - 1;
+  const int iterations = 20000000;
+  auto time_index = [iterations](auto next) {
+    size_t index = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) index = next(index);
+    double ns = std::chrono::duration<double, std::nano>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    volatile size_t sink = index;
+    (void)sink;
+    return ns / iterations;
+  };
+  double modulo_ns = time_index([capacity](size_t i) { return (i + 1) % capacity; });
+  double mask_ns = time_index([mask](size_t i) { return (i + 1) & mask; });
+  std::cout << std::fixed << std::setprecision(2) << "  Index update: % "
+            << modulo_ns << " ns, & mask " << mask_ns << " ns\n";
+  std::cout.unsetf(std::ios::fixed);
+
+  if (rounding_ok && transfer_ok) {
+    std::cout << "[PASSED] Runtime-capacity ring buffer test\n";
+  } else {
+    std::cout << "[FAILED] Runtime-capacity ring buffer test\n";
+  }
+}
+
 }  // namespace w4
 
 // =============================================================================
@@ -720,6 +1693,15 @@ int main() {
   w4::TestProducerConsumer();
   w4::TestHighConcurrency();
   w4::TestTimeout();
+  w4::TestRealWorkloads();
+  w4::TestAdmissionControl();
+  w4::TestBroadcastFanOut();
+  w4::TestEpollReadiness();
+  w4::TestCloseSemantics();
+  w4::TestThreadCpuAccounting();
+  w4::TestFlightRecorder();
+  w4::TestCapacityTuner();
+  w4::TestDynamicRingBuffer();
 
   std::cout << "\n========================================\n";
   std::cout << "All tests completed!\n";
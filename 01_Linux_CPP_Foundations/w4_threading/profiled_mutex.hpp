@@ -0,0 +1,228 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：带统计的互斥锁 - 按锁名记录等待时间、持有时间与争用次数
+//
+// 知识点：
+// 1. 满足 Lockable 要求（lock / unlock / try_lock），可直接替换 std::mutex
+// 2. 快路径先 try_lock：无争用时不读时钟，只多一次计数
+// 3. 持有时间按 1/N 采样，等待时间只在真正发生争用时测量
+// 4. 程序退出时按总等待时间排序输出争用报告
+
+#ifndef W4_THREADING_PROFILED_MUTEX_HPP_
+#define W4_THREADING_PROFILED_MUTEX_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace w4 {
+
+// =============================================================================
+// 用法
+// =============================================================================
+//   ProfiledMutex g_console_mutex("g_console_mutex");   // 替换 std::mutex
+//   std::lock_guard<ProfiledMutex> lock(g_console_mutex);
+//
+// 与条件变量配合时使用 std::condition_variable_any（std::condition_variable
+// 只接受 std::unique_lock<std::mutex>）。
+// 同名的多个锁（例如每个测试各建一个缓冲区）合并统计。
+// =============================================================================
+
+// 每个锁名一份统计，多线程并发更新，全部使用 relaxed 原子操作
+struct LockStats {
+  std::string name;
+  std::atomic<uint64_t> acquisitions{0};
+  std::atomic<uint64_t> contentions{0};   // try_lock 失败、需要等待的次数
+  std::atomic<uint64_t> wait_ns{0};       // 争用时的累计等待时间
+  std::atomic<uint64_t> max_wait_ns{0};
+  std::atomic<uint64_t> hold_samples{0};  // 采样到的持有次数
+  std::atomic<uint64_t> hold_ns{0};       // 采样持有时间之和
+  std::atomic<uint64_t> max_hold_ns{0};
+
+  static void UpdateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+};
+
+// =============================================================================
+// LockProfiler - 全局注册表，析构时（程序退出）输出报告
+// =============================================================================
+// 以函数内静态变量实现：第一个 ProfiledMutex 构造时创建，
+// 因而晚于所有全局 ProfiledMutex 析构，锁里保存的 LockStats 指针始终有效。
+// =============================================================================
+class LockProfiler {
+ public:
+  static LockProfiler& Instance() {
+    static LockProfiler profiler;
+    return profiler;
+  }
+
+  LockStats* Register(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = stats_[name];
+    if (!slot) {
+      slot = std::make_unique<LockStats>();
+      slot->name = name;
+    }
+    return slot.get();
+  }
+
+  // 按总等待时间降序输出；持有时间为采样值（每 kHoldSampleEvery 次取一次）
+  void Report(std::ostream& os) const {
+    std::vector<const LockStats*> rows;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto& [name, stats] : stats_) {
+        if (stats->acquisitions.load(std::memory_order_relaxed) > 0) {
+          rows.push_back(stats.get());
+        }
+      }
+    }
+    std::sort(rows.begin(), rows.end(), [](const LockStats* a, const LockStats* b) {
+      return a->wait_ns.load(std::memory_order_relaxed) >
+             b->wait_ns.load(std::memory_order_relaxed);
+    });
+
+    os << "\n" << std::string(60, '=') << "\n";
+    os << "Lock Contention Report (ranked by total wait)\n";
+    os << std::string(60, '=') << "\n";
+    os << std::left << std::setw(24) << "lock" << std::right << std::setw(10)
+       << "acquires" << std::setw(9) << "contend%" << std::setw(11)
+       << "wait(ms)" << std::setw(11) << "max_wait" << std::setw(11)
+       << "avg_hold" << std::setw(11) << "max_hold" << "\n";
+    os << std::left << std::setw(24) << "" << std::right << std::setw(10) << ""
+       << std::setw(9) << "" << std::setw(11) << "" << std::setw(11) << "(us)"
+       << std::setw(11) << "(us)" << std::setw(11) << "(us)" << "\n";
+
+    for (const LockStats* s : rows) {
+      double acquisitions = static_cast<double>(s->acquisitions.load());
+      double samples = static_cast<double>(s->hold_samples.load());
+      os << std::left << std::setw(24) << s->name << std::right << std::fixed
+         << std::setprecision(2) << std::setw(10) << s->acquisitions.load()
+         << std::setw(9)
+         << 100.0 * static_cast<double>(s->contentions.load()) / acquisitions
+         << std::setw(11) << static_cast<double>(s->wait_ns.load()) / 1e6
+         << std::setw(11) << static_cast<double>(s->max_wait_ns.load()) / 1e3
+         << std::setw(11)
+         << (samples > 0 ? static_cast<double>(s->hold_ns.load()) / samples / 1e3
+                         : 0.0)
+         << std::setw(11) << static_cast<double>(s->max_hold_ns.load()) / 1e3
+         << "\n";
+      os.unsetf(std::ios::fixed);
+    }
+  }
+
+  // 报告开关（默认开启）；测试中可先关闭，避免退出时输出
+  void SetReportAtExit(bool enabled) { report_at_exit_ = enabled; }
+
+  LockProfiler(const LockProfiler&) = delete;
+  LockProfiler& operator=(const LockProfiler&) = delete;
+
+ private:
+  LockProfiler() = default;
+  ~LockProfiler() {
+    if (report_at_exit_ && !stats_.empty()) Report(std::cout);
+  }
+
+  mutable std::mutex mutex_;  // 仅保护注册表本身，不在加锁热路径上
+  std::map<std::string, std::unique_ptr<LockStats>> stats_;
+  bool report_at_exit_ = true;
+};
+
+// =============================================================================
+// ProfiledMutex 类
+// =============================================================================
+// lock() 的开销：
+//   无争用：try_lock 成功 + 一次普通计数；每 kHoldSampleEvery 次汇总计数并读两次时钟
+//   有争用：读两次时钟测量等待时间，再阻塞在底层 std::mutex 上
+// 持有锁期间只有当前线程访问 acquire_seq_ / hold_start_，由锁自身保护。
+// =============================================================================
+class ProfiledMutex {
+ public:
+  static constexpr uint64_t kHoldSampleEvery = 16;
+
+  explicit ProfiledMutex(const char* name = "unnamed")
+      : stats_(LockProfiler::Instance().Register(name)) {}
+
+  // 把尚未汇总的获取次数补进统计
+  ~ProfiledMutex() {
+    stats_->acquisitions.fetch_add(acquire_seq_ % kHoldSampleEvery,
+                                   std::memory_order_relaxed);
+  }
+
+  ProfiledMutex(const ProfiledMutex&) = delete;
+  ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+  void lock() {
+    if (!mutex_.try_lock()) {
+      auto wait_start = Clock::now();
+      mutex_.lock();
+      uint64_t waited = ElapsedNs(wait_start);
+      stats_->contentions.fetch_add(1, std::memory_order_relaxed);
+      stats_->wait_ns.fetch_add(waited, std::memory_order_relaxed);
+      LockStats::UpdateMax(stats_->max_wait_ns, waited);
+    }
+    OnAcquired();
+  }
+
+  bool try_lock() {
+    if (!mutex_.try_lock()) return false;
+    OnAcquired();
+    return true;
+  }
+
+  void unlock() {
+    if (sampling_) {
+      uint64_t held = ElapsedNs(hold_start_);
+      sampling_ = false;
+      stats_->hold_samples.fetch_add(1, std::memory_order_relaxed);
+      stats_->hold_ns.fetch_add(held, std::memory_order_relaxed);
+      LockStats::UpdateMax(stats_->max_hold_ns, held);
+    }
+    mutex_.unlock();
+  }
+
+  const LockStats& Stats() const { return *stats_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static uint64_t ElapsedNs(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start)
+            .count());
+  }
+
+  // 获取次数先记在锁自己的计数器里（受锁保护，非原子），
+  // 每 kHoldSampleEvery 次才汇总一次，避免每次加锁都做一次共享原子写
+  void OnAcquired() {
+    if (++acquire_seq_ % kHoldSampleEvery == 0) {
+      stats_->acquisitions.fetch_add(kHoldSampleEvery, std::memory_order_relaxed);
+      sampling_ = true;
+      hold_start_ = Clock::now();
+    }
+  }
+
+  std::mutex mutex_;
+  LockStats* stats_;
+  // 以下字段只在持锁期间读写
+  uint64_t acquire_seq_ = 0;
+  bool sampling_ = false;
+  Clock::time_point hold_start_{};
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_PROFILED_MUTEX_HPP_
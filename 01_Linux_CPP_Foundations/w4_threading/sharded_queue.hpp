@@ -0,0 +1,316 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：按生产者分片的队列 - 每个生产者独占一条 SPSC 通道
+//
+// 知识点：
+// 1. 单生产者单消费者（SPSC）无锁环形队列：head/tail 分属不同缓存行
+// 2. EventCount：无人等待时通知只需一次原子读，有人等待时才加锁唤醒
+// 3. 公平扫描：消费者从上次成功的下一条通道开始轮询，避免饿死
+// 4. 放弃全局 FIFO，只保证同一生产者内的 FIFO
+
+#ifndef W4_THREADING_SHARDED_QUEUE_HPP_
+#define W4_THREADING_SHARDED_QUEUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么要分片？
+// =============================================================================
+// ThreadSafeRingBuffer 只有一把锁、一组 head/tail：几十个生产者同时 Push 时，
+// 这条缓存行在所有核之间来回迁移（cache line ping-pong），吞吐随线程数下降。
+// 分片后每个生产者只写自己通道的 tail_，生产者之间没有任何共享写。
+// 代价：不同生产者的帧之间不再有全局顺序（多路摄像头本来就互相独立）。
+// =============================================================================
+
+constexpr size_t kCacheLineSize = 64;
+
+// =============================================================================
+// EventCount - 条件变量的"无锁快路径"版本
+// =============================================================================
+// 等待方协议（避免丢失唤醒）：
+//   key = ec.PrepareWait();      // 登记为等待者，记下当前纪元
+//   if (条件已满足) { ec.CancelWait(); 返回; }
+//   ec.Wait(key);                // 纪元变化后返回
+// 通知方：先发布数据，再 NotifyOne()（交出一个元素 / 一个空位）或
+// Notify()（状态变化与所有等待者相关，例如关闭）。
+// 两边都用 seq_cst 顺序：要么通知方看到等待者，要么等待方看到新数据。
+// =============================================================================
+class EventCount {
+ public:
+  uint64_t PrepareWait() {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    return epoch_.load(std::memory_order_seq_cst);
+  }
+
+  void CancelWait() { waiters_.fetch_sub(1, std::memory_order_seq_cst); }
+
+  // 等待纪元变化或超时；返回时已注销等待者身份
+  void Wait(uint64_t key, std::chrono::milliseconds timeout) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, timeout, [this, key]() {
+        return epoch_.load(std::memory_order_relaxed) != key;
+      });
+    }
+    waiters_.fetch_sub(1, std::memory_order_seq_cst);
+  }
+
+  // 唤醒所有等待者（Close / Stop 等全局状态变化）
+  // 快路径：无人等待时只有一次 fence + 原子读，不碰互斥锁
+  void Notify() {
+    if (Advance()) cv_.notify_all();
+  }
+
+  // 只交出一个元素时唤醒一个等待者，避免其余线程被惊群唤醒后又睡回去。
+  // 纪元同样推进：尚未进入 cv 等待的线程看到新纪元会直接返回重试
+  void NotifyOne() {
+    if (Advance()) cv_.notify_one();
+  }
+
+ private:
+  // 有等待者时推进纪元并返回 true
+  bool Advance() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<int> waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+// =============================================================================
+// SpscLane - 单生产者单消费者无锁环形队列
+// =============================================================================
+// head_/tail_ 是单调递增计数器，下标 = 计数器 & (Capacity - 1)
+// 生产者只写 tail_，消费者只写 head_，两者放在不同缓存行避免伪共享；
+// 各自缓存一份对方的游标，只有看起来满/空时才重新读取原子变量。
+// =============================================================================
+template <typename T, size_t Capacity>
+class SpscLane {
+ public:
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Lane capacity must be a power of two");
+
+  bool TryPush(T& item) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == Capacity) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == Capacity) return false;
+    }
+    slots_[tail & kMask] = std::move(item);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::optional<T> TryPop() {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) return std::nullopt;
+    }
+    T item = std::move(slots_[head & kMask]);
+    head_.store(head + 1, std::memory_order_release);
+    return item;
+  }
+
+  // 多个消费者共享通道时，用 try-lock 保证同一时刻只有一个消费者出队，
+  // 抢不到的消费者直接扫描下一条通道（不会阻塞）
+  bool TryAcquireConsumer() {
+    return !consumer_busy_.exchange(true, std::memory_order_acquire);
+  }
+  void ReleaseConsumer() {
+    consumer_busy_.store(false, std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr uint64_t kMask = Capacity - 1;
+
+  // 生产者侧
+  alignas(kCacheLineSize) std::atomic<uint64_t> tail_{0};
+  uint64_t cached_head_ = 0;
+  // 消费者侧
+  alignas(kCacheLineSize) std::atomic<uint64_t> head_{0};
+  uint64_t cached_tail_ = 0;
+  std::atomic<bool> consumer_busy_{false};
+
+  alignas(kCacheLineSize) std::array<T, Capacity> slots_;
+};
+
+// =============================================================================
+// ShardedQueue 类 - 每个生产者一条通道，消费者公平扫描
+// =============================================================================
+// 用法：
+//   ShardedQueue<Frame, 256> queue(num_producers);
+//   // 生产者 i：queue.Push(i, std::move(frame));
+//   // 消费者：size_t cursor = 0; while (auto f = queue.Pop(cursor)) {...}
+//
+// 接口语义与 ThreadSafeRingBuffer 保持一致：
+//   - Push 在通道满时阻塞（可超时），Stop() 后返回 false
+//   - Pop 返回 std::optional，Stop() 后仍会先取完剩余数据
+// =============================================================================
+template <typename T, size_t LaneCapacity>
+class ShardedQueue {
+ public:
+  using Lane = SpscLane<T, LaneCapacity>;
+
+  explicit ShardedQueue(size_t num_lanes) : stopped_(false) {
+    if (num_lanes == 0) {
+      throw std::invalid_argument("ShardedQueue needs at least one lane");
+    }
+    lanes_.reserve(num_lanes);
+    for (size_t i = 0; i < num_lanes; ++i) {
+      lanes_.push_back(std::make_unique<Lane>());
+    }
+  }
+
+  ShardedQueue(const ShardedQueue&) = delete;
+  ShardedQueue& operator=(const ShardedQueue&) = delete;
+
+  // =========================================================================
+  // Push - 写入生产者自己的通道（每条通道只能由一个线程调用）
+  // =========================================================================
+  bool Push(size_t lane, T item,
+            std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    Lane& l = *lanes_[lane];
+    auto deadline = Deadline(timeout);
+    while (true) {
+      if (stopped_.load(std::memory_order_acquire)) return false;
+      if (l.TryPush(item)) {
+        not_empty_.NotifyOne();
+        return true;
+      }
+      // 通道已满：登记等待，再检查一次，避免错过消费者的唤醒
+      uint64_t key = not_full_.PrepareWait();
+      if (stopped_.load(std::memory_order_acquire)) {
+        not_full_.CancelWait();
+        return false;
+      }
+      if (l.TryPush(item)) {
+        not_full_.CancelWait();
+        not_empty_.NotifyOne();
+        return true;
+      }
+      auto slice = RemainingSlice(deadline);
+      if (slice.count() <= 0) {
+        not_full_.CancelWait();
+        return false;
+      }
+      not_full_.Wait(key, slice);
+    }
+  }
+
+  // =========================================================================
+  // Pop - 从 cursor 开始轮询所有通道，cursor 由每个消费者自己持有
+  // =========================================================================
+  std::optional<T> Pop(size_t& cursor,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    auto deadline = Deadline(timeout);
+    while (true) {
+      if (auto item = TryPopAny(cursor)) return item;
+
+      uint64_t key = not_empty_.PrepareWait();
+      if (auto item = TryPopAny(cursor)) {
+        not_empty_.CancelWait();
+        return item;
+      }
+      // 停止且所有通道已空 → 结束
+      if (stopped_.load(std::memory_order_acquire) && AllEmpty()) {
+        not_empty_.CancelWait();
+        return std::nullopt;
+      }
+      auto slice = RemainingSlice(deadline);
+      if (slice.count() <= 0) {
+        not_empty_.CancelWait();
+        return std::nullopt;
+      }
+      not_empty_.Wait(key, slice);
+    }
+  }
+
+  // 与 ThreadSafeRingBuffer 一样，应在生产者不再 Push 之后调用：
+  // 通道是无锁的，Stop() 与并发 Push 之间没有锁来界定先后
+  void Stop() {
+    stopped_.store(true, std::memory_order_release);
+    not_empty_.Notify();
+    not_full_.Notify();
+  }
+
+  bool IsStopped() const { return stopped_.load(std::memory_order_acquire); }
+  size_t NumLanes() const { return lanes_.size(); }
+  static constexpr size_t GetLaneCapacity() { return LaneCapacity; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // 等待按分片进行：即使出现极端的唤醒丢失，也会在分片结束后重新扫描
+  static constexpr std::chrono::milliseconds kWaitSlice{10};
+
+  static Clock::time_point Deadline(std::chrono::milliseconds timeout) {
+    if (timeout == std::chrono::milliseconds::max()) return Clock::time_point::max();
+    return Clock::now() + timeout;
+  }
+
+  static std::chrono::milliseconds RemainingSlice(Clock::time_point deadline) {
+    if (deadline == Clock::time_point::max()) return kWaitSlice;
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - Clock::now());
+    return left < kWaitSlice ? left : kWaitSlice;
+  }
+
+  std::optional<T> TryPopAny(size_t& cursor) {
+    const size_t n = lanes_.size();
+    for (size_t k = 0; k < n; ++k) {
+      size_t index = (cursor + k) % n;
+      Lane& lane = *lanes_[index];
+      if (lane.Empty() || !lane.TryAcquireConsumer()) continue;
+      std::optional<T> item = lane.TryPop();
+      lane.ReleaseConsumer();
+      if (item.has_value()) {
+        cursor = index + 1;  // 下次从下一条通道开始，保证轮转公平
+        // 空出的位置只属于这条通道的生产者，而等待者里分不出是谁：
+        // 这里仍然唤醒全部（通道满是少见情况，快路径无人等待时不加锁）
+        not_full_.Notify();
+        return item;
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool AllEmpty() const {
+    for (const auto& lane : lanes_) {
+      if (!lane->Empty()) return false;
+    }
+    return true;
+  }
+
+  std::vector<std::unique_ptr<Lane>> lanes_;
+  std::atomic<bool> stopped_;
+  EventCount not_empty_;  // 消费者等待
+  EventCount not_full_;   // 生产者等待（通道满）
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_SHARDED_QUEUE_HPP_
@@ -0,0 +1,227 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：ShardedQueue vs ThreadSafeRingBuffer - 多生产者入队吞吐对比
+//
+// 知识点：
+// 1. 单锁队列在多生产者下的缓存行争用
+// 2. 分片后每个生产者只写自己的通道
+// 3. 验证每个生产者内部仍保持 FIFO
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "sharded_queue.hpp"
+#include "thread_safe_ring_buffer.hpp"
+
+namespace w4 {
+
+namespace {
+
+constexpr size_t kQueueCapacity = 1024;
+constexpr int kNumConsumers = 4;
+constexpr int kItemsPerProducer = 20000;
+
+// 元素编码：高 32 位 = 生产者编号，低 32 位 = 该生产者内的序号
+uint64_t Encode(int producer, int seq) {
+  return (static_cast<uint64_t>(producer) << 32) | static_cast<uint32_t>(seq);
+}
+
+struct BenchResult {
+  double mops = 0.0;  // 百万次/秒
+  uint64_t consumed = 0;
+  bool per_producer_fifo = true;
+};
+
+// 消费端校验：同一消费者看到的同一生产者序号必须递增
+class FifoChecker {
+ public:
+  explicit FifoChecker(int num_producers)
+      : last_(static_cast<size_t>(num_producers), -1) {}
+
+  void Observe(uint64_t value) {
+    size_t producer = static_cast<size_t>(value >> 32);
+    int64_t seq = static_cast<int64_t>(value & 0xffffffffu);
+    if (seq <= last_[producer]) ok_ = false;
+    last_[producer] = seq;
+  }
+
+  bool Ok() const { return ok_; }
+
+ private:
+  std::vector<int64_t> last_;
+  bool ok_ = true;
+};
+
+BenchResult BenchRingBuffer(int num_producers) {
+  ThreadSafeRingBuffer<uint64_t, kQueueCapacity> buffer;
+  std::atomic<uint64_t> consumed(0);
+  std::atomic<bool> fifo_ok(true);
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    consumers.emplace_back([&]() {
+      FifoChecker checker(num_producers);
+      uint64_t local = 0;
+      while (auto value = buffer.Pop()) {
+        checker.Observe(*value);
+        ++local;
+      }
+      consumed += local;
+      if (!checker.Ok()) fifo_ok = false;
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&buffer, p]() {
+      for (int i = 0; i < kItemsPerProducer; ++i) buffer.Push(Encode(p, i));
+    });
+  }
+  for (auto& t : producers) t.join();
+  buffer.Stop();
+  for (auto& t : consumers) t.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  BenchResult r;
+  r.consumed = consumed;
+  r.mops = static_cast<double>(r.consumed) / seconds / 1e6;
+  r.per_producer_fifo = fifo_ok;
+  return r;
+}
+
+// 每条通道的容量：单锁队列的总容量平均分给各通道，向下取到 2 的幂，
+// 使两种队列缓冲的元素总数相同（不会因取整而多于单锁队列）
+constexpr size_t LaneCapacity(int num_producers) {
+  size_t share = kQueueCapacity / static_cast<size_t>(num_producers);
+  size_t capacity = 1;
+  while (capacity * 2 <= share) capacity *= 2;
+  return capacity;
+}
+
+// 通道容量是模板参数：每种生产者数量单独实例化
+template <int kNumProducers>
+BenchResult BenchSharded() {
+  constexpr int num_producers = kNumProducers;
+  constexpr size_t kLaneCapacity = LaneCapacity(kNumProducers);
+  ShardedQueue<uint64_t, kLaneCapacity> queue(static_cast<size_t>(num_producers));
+  std::atomic<uint64_t> consumed(0);
+  std::atomic<bool> fifo_ok(true);
+
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    consumers.emplace_back([&, c]() {
+      FifoChecker checker(num_producers);
+      // 错开起始通道，减少消费者之间在同一通道上的 try-lock 冲突
+      size_t cursor = static_cast<size_t>(c) * queue.NumLanes() / kNumConsumers;
+      uint64_t local = 0;
+      while (auto value = queue.Pop(cursor)) {
+        checker.Observe(*value);
+        ++local;
+      }
+      consumed += local;
+      if (!checker.Ok()) fifo_ok = false;
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (int i = 0; i < kItemsPerProducer; ++i) {
+        queue.Push(static_cast<size_t>(p), Encode(p, i));
+      }
+    });
+  }
+  for (auto& t : producers) t.join();
+  queue.Stop();
+  for (auto& t : consumers) t.join();
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  BenchResult r;
+  r.consumed = consumed;
+  r.mops = static_cast<double>(r.consumed) / seconds / 1e6;
+  r.per_producer_fifo = fifo_ok;
+  return r;
+}
+
+// 同一生产者数量下两种队列各跑一次；capacity 列是各自缓冲的元素总数
+template <int kNumProducers>
+bool RunRow() {
+  const uint64_t expected =
+      static_cast<uint64_t>(kNumProducers) * kItemsPerProducer;
+  const size_t sharded_capacity = LaneCapacity(kNumProducers) * kNumProducers;
+  BenchResult locked = BenchRingBuffer(kNumProducers);
+  BenchResult sharded = BenchSharded<kNumProducers>();
+
+  bool ok = true;
+  for (auto [name, capacity, r] :
+       {std::make_tuple("ThreadSafeRingBuffer", kQueueCapacity, locked),
+        std::make_tuple("ShardedQueue", sharded_capacity, sharded)}) {
+    std::cout << std::left << std::setw(12) << kNumProducers << std::setw(26)
+              << name << std::right << std::setw(10) << capacity << std::fixed
+              << std::setprecision(2) << std::setw(12) << r.mops
+              << std::setw(12) << r.consumed << std::setw(8)
+              << (r.per_producer_fifo ? "ok" : "BROKEN") << "\n";
+    std::cout.unsetf(std::ios::fixed);
+    ok = ok && r.consumed == expected && r.per_producer_fifo;
+  }
+  std::cout << "  speedup: " << std::fixed << std::setprecision(2)
+            << sharded.mops / locked.mops << "x\n";
+  std::cout.unsetf(std::ios::fixed);
+  return ok;
+}
+
+}  // namespace
+
+void RunShardedBenchmark() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Benchmark: Many-Producer Ingestion (" << kNumConsumers
+            << " consumers, " << kItemsPerProducer << " items/producer)\n";
+  std::cout << std::string(60, '=') << "\n";
+  std::cout << "Hardware threads: " << std::thread::hardware_concurrency()
+            << "\n";
+
+  std::cout << std::left << std::setw(12) << "producers" << std::setw(26)
+            << "queue" << std::right << std::setw(10) << "capacity"
+            << std::setw(12) << "Mops/s" << std::setw(12) << "consumed"
+            << std::setw(8) << "FIFO"
+            << "\n";
+
+  bool all_ok = true;
+  all_ok &= RunRow<4>();
+  all_ok &= RunRow<16>();
+  all_ok &= RunRow<32>();
+
+  if (all_ok) {
+    std::cout << "[PASSED] No loss, per-producer FIFO preserved\n";
+  } else {
+    std::cout << "[FAILED] Data loss or per-producer reordering detected\n";
+  }
+}
+
+}  // namespace w4
+
+int main() {
+  std::cout << "========================================\n";
+  std::cout << "W4: 分片队列 vs 单锁环形缓冲区\n";
+  std::cout << "========================================\n";
+
+  w4::RunShardedBenchmark();
+
+  std::cout << "\n========================================\n";
+  std::cout << "All benchmarks completed!\n";
+  std::cout << "========================================\n";
+  return 0;
+}
@@ -0,0 +1,608 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：跨进程共享内存帧环形缓冲区（采集进程 ⇄ 推理进程）
+//
+// 知识点：
+// 1. memfd_create / shm_open + mmap(MAP_SHARED) 建立跨进程共享映射
+// 2. PTHREAD_PROCESS_SHARED 的 mutex / condition_variable
+// 3. PTHREAD_MUTEX_ROBUST：持锁进程崩溃后由对端恢复（EOWNERDEAD）
+// 4. 帧数据直接写入映射内的 slab，消费进程零拷贝读取像素
+
+#ifndef W4_THREADING_SHM_FRAME_RING_HPP_
+#define W4_THREADING_SHM_FRAME_RING_HPP_
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace w4 {
+
+// =============================================================================
+// 共享映射布局
+// =============================================================================
+//
+//   ┌──────────────────┬──────────────────────────┬───────────────────────────┐
+//   │ ShmRingHeader    │ ShmFrameDesc[slot_count] │ slab: slot_count × slot   │
+//   │ (锁/条件变量/游标)│ (每个槽的帧元数据)         │ (像素数据，64 字节对齐)     │
+//   └──────────────────┴──────────────────────────┴───────────────────────────┘
+//
+// 设计考量：
+// 1. 一写一读（SPSC）：一个采集进程写、一个推理进程读。
+//    写端只修改 tail_，读端只修改 head_，槽位所有权由游标区间决定：
+//      [head_, tail_)  已发布，归读端
+//      tail_ 对应的槽  写端正在填充（尚未发布）
+// 2. head_/tail_ 是单调递增的 64 位计数器，槽位下标 = 计数器 % slot_count
+// 3. 映射中只存放偏移量，不存放指针（两个进程的映射地址不同）
+// =============================================================================
+
+// 帧元数据 - 与像素一起存放在共享映射中
+struct ShmFrameDesc {
+  uint64_t frame_id;
+  int64_t timestamp;       // steady_clock 纳秒（同一台机器上跨进程可比）
+  int32_t width;
+  int32_t height;
+  int32_t channels;
+  uint32_t payload_bytes;  // 实际写入 slab 的字节数
+  uint64_t generation;     // 发布该帧时映射的代数（用于识别崩溃恢复前后的帧）
+};
+
+namespace detail {
+
+constexpr uint32_t kShmRingMagic = 0x45414652;  // "EAFR"
+constexpr uint32_t kShmRingVersion = 1;
+constexpr size_t kShmSlabAlignment = 64;        // 缓存行对齐，便于 SIMD 读取
+
+constexpr size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+struct ShmRingHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t reserved;
+  uint64_t slot_bytes;       // 每个槽的像素容量
+  uint64_t desc_offset;      // ShmFrameDesc 数组相对映射起点的偏移
+  uint64_t slab_offset;      // slab 相对映射起点的偏移
+  uint64_t mapping_bytes;    // 整个映射大小
+
+  pthread_mutex_t mutex;     // ROBUST + PROCESS_SHARED
+  pthread_cond_t not_full;   // PROCESS_SHARED + CLOCK_MONOTONIC
+  pthread_cond_t not_empty;
+
+  uint64_t head;             // 读端游标（仅读端修改）
+  uint64_t tail;             // 写端游标（仅写端修改）
+  uint64_t generation;       // 每次角色重连或锁恢复时 +1
+  uint64_t recoveries;       // EOWNERDEAD 恢复次数
+  int32_t producer_pid;      // 0 表示无写端
+  int32_t consumer_pid;      // 0 表示无读端
+  uint32_t stopped;
+  uint32_t padding;
+};
+
+inline size_t MappingBytes(uint32_t slot_count, size_t slot_bytes) {
+  size_t desc_offset = AlignUp(sizeof(ShmRingHeader), kShmSlabAlignment);
+  size_t slab_offset = AlignUp(desc_offset + slot_count * sizeof(ShmFrameDesc),
+                               kShmSlabAlignment);
+  return slab_offset + slot_count * AlignUp(slot_bytes, kShmSlabAlignment);
+}
+
+inline std::system_error SysError(const char* what, int err = errno) {
+  return std::system_error(err, std::generic_category(), what);
+}
+
+// 计算 CLOCK_MONOTONIC 上的绝对截止时间（pthread_cond_timedwait 需要）
+inline timespec DeadlineAfter(std::chrono::milliseconds timeout) {
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t ns = static_cast<int64_t>(now.tv_nsec) +
+               std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)
+                   .count();
+  timespec deadline{};
+  deadline.tv_sec = now.tv_sec + static_cast<time_t>(ns / 1000000000);
+  deadline.tv_nsec = static_cast<long>(ns % 1000000000);
+  return deadline;
+}
+
+// 对端存活检测：kill(pid, 0) 对僵尸进程同样成功，因此再检查 /proc 中的状态
+inline bool ProcessAlive(int32_t pid) {
+  if (pid <= 0) return false;
+  if (kill(pid, 0) != 0 && errno != EPERM) return false;
+
+  std::string path = "/proc/" + std::to_string(pid) + "/stat";
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return true;  // 无 /proc 时退化为 kill 检测
+  char buf[256];
+  ssize_t n = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (n <= 0) return true;
+  buf[n] = '\0';
+  // 格式："pid (comm) S ..."，comm 可能含空格，取最后一个 ')' 之后的状态字符
+  const char* paren = strrchr(buf, ')');
+  return paren == nullptr || paren[1] == '\0' || paren[2] != 'Z';
+}
+
+}  // namespace detail
+
+// =============================================================================
+// ShmFrameRing 类 - 进程间共享的帧环形缓冲区
+// =============================================================================
+// 用法（fork 场景）：
+//   auto ring = ShmFrameRing::CreateAnonymous(8, 640 * 480 * 3);
+//   if (fork() == 0) {             // 子进程：推理
+//     ring.AttachConsumer();
+//     while (auto frame = ring.AcquireRead()) { Infer(frame->Pixels()); }
+//   } else {                       // 父进程：采集
+//     ring.AttachProducer();
+//     auto slot = ring.AcquireWrite();
+//     Capture(slot->Pixels());     // 直接写入共享 slab，无中间缓冲
+//     slot->Commit(desc);
+//   }
+//
+// 崩溃处理：
+// - 持锁进程崩溃：下一个加锁者收到 EOWNERDEAD，调用
+//   pthread_mutex_consistent() 恢复锁，并将 generation/recoveries 加一。
+//   临界区内只做游标和元数据的小量更新，且游标最后写入，因此状态总是一致的。
+// - 写端在填充像素时崩溃：tail_ 未推进，半成品帧从未发布。
+// - 读端在处理帧时崩溃：head_ 未推进，新读端重连后会重新读到这一帧
+//   （至少一次语义）。
+// - 对端进程消失时，阻塞等待会按固定间隔醒来检查对端 pid 是否存活，
+//   避免永远睡在条件变量上。
+//
+// 槽位独占：每一端同一时间最多持有一个槽位（写端 tail_ 槽、读端 head_ 槽）。
+// 在归还前再次 Acquire 会拿到同一个槽，归还两次则游标多推进一次，
+// 因此第二次 Acquire 直接抛 std::logic_error。该标记是进程本地的，
+// 持有槽位的进程崩溃后不会残留在共享映射中。
+// =============================================================================
+class ShmFrameRing {
+ public:
+  // ---------------------------------------------------------------------------
+  // WriteSlot - 写端持有的槽位（RAII）
+  // ---------------------------------------------------------------------------
+  // 析构时若未 Commit() 则视为放弃，不会发布任何数据
+  class WriteSlot {
+   public:
+    WriteSlot(WriteSlot&& other) noexcept
+        : ring_(std::exchange(other.ring_, nullptr)), index_(other.index_) {}
+    WriteSlot& operator=(WriteSlot&&) = delete;
+    WriteSlot(const WriteSlot&) = delete;
+    WriteSlot& operator=(const WriteSlot&) = delete;
+
+    // 未 Commit() 即放弃：不发布数据，只归还槽位的独占权
+    ~WriteSlot() {
+      if (ring_ != nullptr) ring_->write_outstanding_.store(false);
+    }
+
+    uint8_t* Pixels() const { return ring_->SlotPixels(index_); }
+    size_t Capacity() const { return ring_->SlotBytes(); }
+
+    // 发布帧：元数据写入描述符后推进 tail_，并唤醒读端
+    bool Commit(const ShmFrameDesc& desc) {
+      if (ring_ == nullptr || desc.payload_bytes > Capacity()) return false;
+      ShmFrameRing* ring = std::exchange(ring_, nullptr);
+      bool published = ring->Publish(index_, desc);
+      ring->write_outstanding_.store(false);
+      return published;
+    }
+
+   private:
+    friend class ShmFrameRing;
+    WriteSlot(ShmFrameRing* ring, uint64_t index) : ring_(ring), index_(index) {}
+
+    ShmFrameRing* ring_;
+    uint64_t index_;
+  };
+
+  // ---------------------------------------------------------------------------
+  // ReadSlot - 读端持有的槽位（RAII）
+  // ---------------------------------------------------------------------------
+  // 像素指针直接指向共享 slab；析构时归还槽位给写端
+  class ReadSlot {
+   public:
+    ReadSlot(ReadSlot&& other) noexcept
+        : ring_(std::exchange(other.ring_, nullptr)),
+          index_(other.index_),
+          desc_(other.desc_) {}
+    ReadSlot& operator=(ReadSlot&&) = delete;
+    ReadSlot(const ReadSlot&) = delete;
+    ReadSlot& operator=(const ReadSlot&) = delete;
+
+    ~ReadSlot() {
+      if (ring_ != nullptr) ring_->Release();
+    }
+
+    const uint8_t* Pixels() const { return ring_->SlotPixels(index_); }
+    const ShmFrameDesc& Desc() const { return desc_; }
+
+   private:
+    friend class ShmFrameRing;
+    ReadSlot(ShmFrameRing* ring, uint64_t index, const ShmFrameDesc& desc)
+        : ring_(ring), index_(index), desc_(desc) {}
+
+    ShmFrameRing* ring_;
+    uint64_t index_;
+    ShmFrameDesc desc_;
+  };
+
+  // ---------------------------------------------------------------------------
+  // 创建 / 打开
+  // ---------------------------------------------------------------------------
+
+  // 匿名共享内存（memfd），fd 随 fork 继承，或经 SCM_RIGHTS 传给其他进程
+  static ShmFrameRing CreateAnonymous(uint32_t slot_count, size_t slot_bytes) {
+    int fd = static_cast<int>(
+        syscall(SYS_memfd_create, "w4_frame_ring", 0U));
+    if (fd < 0) throw detail::SysError("memfd_create");
+    return CreateOnFd(fd, slot_count, slot_bytes);
+  }
+
+  // 具名共享内存（/dev/shm/<name>），无亲缘关系的进程通过 OpenNamed() 打开
+  static ShmFrameRing CreateNamed(const std::string& name, uint32_t slot_count,
+                                  size_t slot_bytes) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) throw detail::SysError("shm_open(create)");
+    return CreateOnFd(fd, slot_count, slot_bytes);
+  }
+
+  static ShmFrameRing OpenNamed(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) throw detail::SysError("shm_open(open)");
+    return MapExisting(fd);
+  }
+
+  static void UnlinkNamed(const std::string& name) { shm_unlink(name.c_str()); }
+
+  ShmFrameRing(ShmFrameRing&& other) noexcept
+      : fd_(std::exchange(other.fd_, -1)),
+        base_(std::exchange(other.base_, nullptr)),
+        bytes_(std::exchange(other.bytes_, 0)),
+        write_outstanding_(other.write_outstanding_.load()),
+        read_outstanding_(other.read_outstanding_.load()) {}
+
+  ShmFrameRing& operator=(ShmFrameRing&&) = delete;
+  ShmFrameRing(const ShmFrameRing&) = delete;
+  ShmFrameRing& operator=(const ShmFrameRing&) = delete;
+
+  ~ShmFrameRing() {
+    if (base_ != nullptr) munmap(base_, bytes_);
+    if (fd_ >= 0) close(fd_);
+  }
+
+  // ---------------------------------------------------------------------------
+  // 角色注册：记录 pid 供对端做存活检测，并推进 generation
+  // ---------------------------------------------------------------------------
+  void AttachProducer() {
+    Lock();
+    Header()->producer_pid = static_cast<int32_t>(getpid());
+    ++Header()->generation;
+    Unlock();
+  }
+
+  void AttachConsumer() {
+    Lock();
+    Header()->consumer_pid = static_cast<int32_t>(getpid());
+    ++Header()->generation;
+    Unlock();
+  }
+
+  // ---------------------------------------------------------------------------
+  // AcquireWrite - 获取下一个可写槽位
+  // ---------------------------------------------------------------------------
+  // 返回 std::nullopt：超时 / 已停止 / 读端进程已退出（仅报告一次）
+  // 抛 std::logic_error：上一个 WriteSlot 尚未 Commit 或析构
+  std::optional<WriteSlot> AcquireWrite(
+      std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    if (write_outstanding_.exchange(true)) {
+      throw std::logic_error("AcquireWrite: previous WriteSlot still held");
+    }
+    ShmRingHeader* h = Header();
+    Lock();
+    bool ok = WaitFor(&h->not_full, timeout, [h]() {
+      return h->tail - h->head < h->slot_count || h->stopped != 0;
+    }, &h->consumer_pid);
+    uint64_t index = h->tail % h->slot_count;
+    bool stopped = h->stopped != 0;
+    Unlock();
+    if (!ok || stopped) {
+      write_outstanding_.store(false);
+      return std::nullopt;
+    }
+    return WriteSlot(this, index);
+  }
+
+  // ---------------------------------------------------------------------------
+  // AcquireRead - 获取最早发布的帧
+  // ---------------------------------------------------------------------------
+  // 与 ThreadSafeRingBuffer::Pop 一致：停止后仍会先读完剩余帧
+  // 抛 std::logic_error：上一个 ReadSlot 尚未析构
+  std::optional<ReadSlot> AcquireRead(
+      std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    if (read_outstanding_.exchange(true)) {
+      throw std::logic_error("AcquireRead: previous ReadSlot still held");
+    }
+    ShmRingHeader* h = Header();
+    Lock();
+    bool ok = WaitFor(&h->not_empty, timeout, [h]() {
+      return h->tail != h->head || h->stopped != 0;
+    }, &h->producer_pid);
+    if (!ok || h->tail == h->head) {
+      Unlock();
+      read_outstanding_.store(false);
+      return std::nullopt;
+    }
+    uint64_t index = h->head % h->slot_count;
+    ShmFrameDesc desc = Descs()[index];
+    Unlock();
+    return ReadSlot(this, index, desc);
+  }
+
+  // 停止：唤醒两端所有等待者（停止标志保存在共享映射中，对两个进程都可见）
+  void Stop() {
+    Lock();
+    Header()->stopped = 1;
+    Unlock();
+    pthread_cond_broadcast(&Header()->not_full);
+    pthread_cond_broadcast(&Header()->not_empty);
+  }
+
+  // 查询方法（用于调试和统计）
+  size_t Size() {
+    Lock();
+    size_t size = static_cast<size_t>(Header()->tail - Header()->head);
+    Unlock();
+    return size;
+  }
+
+  uint64_t Generation() {
+    Lock();
+    uint64_t generation = Header()->generation;
+    Unlock();
+    return generation;
+  }
+
+  uint64_t Recoveries() {
+    Lock();
+    uint64_t recoveries = Header()->recoveries;
+    Unlock();
+    return recoveries;
+  }
+
+  // 故障注入（仅用于测试）：持锁状态下直接退出进程，
+  // 模拟在临界区内崩溃；下一个加锁者会收到 EOWNERDEAD
+  [[noreturn]] void ExitWhileHoldingLockForTesting(int exit_code) {
+    Lock();
+    _exit(exit_code);
+  }
+
+  uint32_t SlotCount() const { return Header()->slot_count; }
+  size_t SlotBytes() const { return static_cast<size_t>(Header()->slot_bytes); }
+  size_t MappingBytes() const { return bytes_; }
+  int Fd() const { return fd_; }
+
+ private:
+  using ShmRingHeader = detail::ShmRingHeader;
+
+  // 对端存活检测间隔：条件变量等待按此粒度醒来
+  static constexpr std::chrono::milliseconds kPeerCheckInterval{50};
+
+  ShmFrameRing(int fd, void* base, size_t bytes)
+      : fd_(fd), base_(base), bytes_(bytes) {}
+
+  static ShmFrameRing CreateOnFd(int fd, uint32_t slot_count,
+                                 size_t slot_bytes) {
+    if (slot_count == 0 || slot_bytes == 0) {
+      close(fd);
+      throw std::invalid_argument("slot_count and slot_bytes must be > 0");
+    }
+    size_t bytes = detail::MappingBytes(slot_count, slot_bytes);
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+      int err = errno;
+      close(fd);
+      throw detail::SysError("ftruncate", err);
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      int err = errno;
+      close(fd);
+      throw detail::SysError("mmap", err);
+    }
+    ShmFrameRing ring(fd, base, bytes);
+    ring.InitHeader(slot_count, slot_bytes);
+    return ring;
+  }
+
+  static ShmFrameRing MapExisting(int fd) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+      int err = errno;
+      close(fd);
+      throw detail::SysError("fstat", err);
+    }
+    size_t bytes = static_cast<size_t>(st.st_size);
+    if (bytes < sizeof(ShmRingHeader)) {
+      close(fd);
+      throw std::runtime_error("shared ring mapping is too small");
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+      int err = errno;
+      close(fd);
+      throw detail::SysError("mmap", err);
+    }
+    ShmFrameRing ring(fd, base, bytes);
+    const ShmRingHeader* h = ring.Header();
+    if (h->magic != detail::kShmRingMagic ||
+        h->version != detail::kShmRingVersion || h->mapping_bytes != bytes) {
+      throw std::runtime_error("shared ring header mismatch");
+    }
+    return ring;
+  }
+
+  void InitHeader(uint32_t slot_count, size_t slot_bytes) {
+    ShmRingHeader* h = Header();
+    h->slot_count = slot_count;
+    h->slot_bytes = detail::AlignUp(slot_bytes, detail::kShmSlabAlignment);
+    h->desc_offset =
+        detail::AlignUp(sizeof(ShmRingHeader), detail::kShmSlabAlignment);
+    h->slab_offset = detail::AlignUp(
+        h->desc_offset + slot_count * sizeof(ShmFrameDesc),
+        detail::kShmSlabAlignment);
+    h->mapping_bytes = bytes_;
+    h->head = 0;
+    h->tail = 0;
+    h->generation = 0;
+    h->recoveries = 0;
+    h->producer_pid = 0;
+    h->consumer_pid = 0;
+    h->stopped = 0;
+
+    pthread_mutexattr_t mattr;
+    pthread_mutexattr_init(&mattr);
+    pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&h->mutex, &mattr);
+    pthread_mutexattr_destroy(&mattr);
+
+    pthread_condattr_t cattr;
+    pthread_condattr_init(&cattr);
+    pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cattr, CLOCK_MONOTONIC);
+    pthread_cond_init(&h->not_full, &cattr);
+    pthread_cond_init(&h->not_empty, &cattr);
+    pthread_condattr_destroy(&cattr);
+
+    // magic 最后写入：OpenNamed() 看到 magic 即表示头部已初始化完毕
+    std::atomic_thread_fence(std::memory_order_release);
+    h->version = detail::kShmRingVersion;
+    h->magic = detail::kShmRingMagic;
+  }
+
+  ShmRingHeader* Header() const { return static_cast<ShmRingHeader*>(base_); }
+
+  ShmFrameDesc* Descs() const {
+    return reinterpret_cast<ShmFrameDesc*>(static_cast<uint8_t*>(base_) +
+                                           Header()->desc_offset);
+  }
+
+  uint8_t* SlotPixels(uint64_t index) const {
+    return static_cast<uint8_t*>(base_) + Header()->slab_offset +
+           index * Header()->slot_bytes;
+  }
+
+  // ---------------------------------------------------------------------------
+  // 加锁 - 处理持锁进程崩溃（EOWNERDEAD）
+  // ---------------------------------------------------------------------------
+  void Lock() {
+    int rc = LockNoThrow();
+    if (rc != 0) throw detail::SysError("pthread_mutex_lock", rc);
+  }
+
+  // 不抛异常的版本（供析构路径使用）：返回 0 表示已持锁，
+  // 否则为错误码（例如恢复失败后的 ENOTRECOVERABLE），此时未持锁
+  int LockNoThrow() noexcept {
+    int rc = pthread_mutex_lock(&Header()->mutex);
+    if (rc == EOWNERDEAD) {
+      RecoverLocked();
+      return 0;
+    }
+    return rc;
+  }
+
+  void Unlock() { pthread_mutex_unlock(&Header()->mutex); }
+
+  void RecoverLocked() {
+    ShmRingHeader* h = Header();
+    // 游标总是在临界区最后一步写入，因此只需修正越界情况
+    if (h->tail - h->head > h->slot_count) h->head = h->tail - h->slot_count;
+    if (!detail::ProcessAlive(h->producer_pid)) h->producer_pid = 0;
+    if (!detail::ProcessAlive(h->consumer_pid)) h->consumer_pid = 0;
+    ++h->generation;
+    ++h->recoveries;
+    pthread_mutex_consistent(&h->mutex);
+  }
+
+  // 在持锁状态下等待条件满足；按 kPeerCheckInterval 醒来检查对端是否存活
+  // 返回 false：超时，或对端曾注册但进程已退出。
+  // 对端退出只报告一次（pid 清零），之后的等待会继续等待新对端 Attach
+  template <typename Predicate>
+  bool WaitFor(pthread_cond_t* cv, std::chrono::milliseconds timeout,
+               Predicate predicate, int32_t* peer_pid) {
+    auto start = std::chrono::steady_clock::now();
+    while (!predicate()) {
+      if (*peer_pid != 0 && !detail::ProcessAlive(*peer_pid)) {
+        *peer_pid = 0;
+        return false;
+      }
+
+      auto slice = kPeerCheckInterval;
+      if (timeout != std::chrono::milliseconds::max()) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        if (elapsed >= timeout) return false;
+        if (timeout - elapsed < slice) slice = timeout - elapsed;
+      }
+
+      timespec deadline = detail::DeadlineAfter(slice);
+      int rc = pthread_cond_timedwait(cv, &Header()->mutex, &deadline);
+      if (rc == EOWNERDEAD) RecoverLocked();
+    }
+    return true;
+  }
+
+  bool Publish(uint64_t index, const ShmFrameDesc& desc) {
+    ShmRingHeader* h = Header();
+    Lock();
+    if (h->stopped != 0) {
+      Unlock();
+      return false;
+    }
+    Descs()[index] = desc;
+    Descs()[index].generation = h->generation;
+    ++h->tail;  // 最后推进游标：崩溃在此之前则帧不会被发布
+    Unlock();
+    pthread_cond_signal(&h->not_empty);
+    return true;
+  }
+
+  // 由 ~ReadSlot 调用，不能抛异常：锁不可用时只清除本进程的持有标记，
+  // 槽位不归还（锁已不可恢复，环形缓冲区整体不可用）
+  void Release() noexcept {
+    ShmRingHeader* h = Header();
+    if (LockNoThrow() != 0) {
+      read_outstanding_.store(false);
+      return;
+    }
+    if (h->head != h->tail) ++h->head;
+    Unlock();
+    read_outstanding_.store(false);
+    pthread_cond_signal(&h->not_full);
+  }
+
+  int fd_;
+  void* base_;
+  size_t bytes_;
+  // 本进程是否持有未归还的槽位（每端最多一个）
+  std::atomic<bool> write_outstanding_{false};
+  std::atomic<bool> read_outstanding_{false};
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_SHM_FRAME_RING_HPP_
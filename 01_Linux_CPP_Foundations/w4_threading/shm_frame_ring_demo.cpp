@@ -0,0 +1,304 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：ShmFrameRing 跨进程演示 - 采集进程与推理进程隔离
+//
+// 知识点：
+// 1. fork() 后父子进程共享同一个 memfd 映射
+// 2. 消费进程直接读取 slab 中的像素（零拷贝）
+// 3. 消费进程崩溃后，生产进程及时感知，新消费进程可重连继续消费
+// 4. 进程在临界区内（持有 robust mutex）死亡后，对端通过 EOWNERDEAD 恢复锁
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "shm_frame_ring.hpp"
+
+namespace w4 {
+
+namespace {
+
+constexpr int kWidth = 640;
+constexpr int kHeight = 480;
+constexpr int kChannels = 3;
+constexpr size_t kFrameBytes = static_cast<size_t>(kWidth * kHeight * kChannels);
+
+// 采集端：直接在共享 slab 中生成像素（模拟 DMA / V4L2 写入）
+void FillFrame(uint8_t* pixels, uint64_t frame_id) {
+  for (size_t i = 0; i < kFrameBytes; ++i) {
+    pixels[i] = static_cast<uint8_t>((i + frame_id) % 251);
+  }
+}
+
+bool VerifyFrame(const uint8_t* pixels, uint64_t frame_id) {
+  for (size_t i = 0; i < kFrameBytes; i += 4093) {
+    if (pixels[i] != static_cast<uint8_t>((i + frame_id) % 251)) return false;
+  }
+  return true;
+}
+
+bool ProduceFrame(ShmFrameRing& ring, uint64_t frame_id,
+                  std::chrono::milliseconds timeout) {
+  auto slot = ring.AcquireWrite(timeout);
+  if (!slot.has_value()) return false;
+
+  FillFrame(slot->Pixels(), frame_id);
+
+  ShmFrameDesc desc{};
+  desc.frame_id = frame_id;
+  desc.timestamp = std::chrono::steady_clock::now().time_since_epoch().count();
+  desc.width = kWidth;
+  desc.height = kHeight;
+  desc.channels = kChannels;
+  desc.payload_bytes = static_cast<uint32_t>(kFrameBytes);
+  return slot->Commit(desc);
+}
+
+// 子进程入口：消费帧直到停止；crash_after > 0 时在持有第 crash_after 帧时自杀
+// 退出码：0 = 所有帧校验通过，1 = 校验失败
+[[noreturn]] void ConsumerProcess(ShmFrameRing& ring, uint64_t first_expected,
+                                  int crash_after) {
+  ring.AttachConsumer();
+  uint64_t expected = first_expected;
+  int consumed = 0;
+  bool ok = true;
+
+  while (auto frame = ring.AcquireRead()) {
+    const ShmFrameDesc& desc = frame->Desc();
+    if (desc.frame_id != expected || !VerifyFrame(frame->Pixels(), expected)) {
+      ok = false;
+    }
+    ++expected;
+    ++consumed;
+    if (crash_after > 0 && consumed == crash_after) {
+      raise(SIGKILL);  // 模拟推理进程崩溃：槽位未归还
+    }
+  }
+  _exit(ok ? 0 : 1);
+}
+
+int WaitChild(pid_t pid) {
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (WIFEXITED(status)) return WEXITSTATUS(status);
+  return -WTERMSIG(status);
+}
+
+}  // namespace
+
+// 测试1：跨进程零拷贝传输
+void TestCrossProcessTransfer() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 1: Cross-Process Zero-Copy Transfer\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  const uint64_t total_frames = 120;
+  auto ring = ShmFrameRing::CreateAnonymous(8, kFrameBytes);
+  std::cout << "Mapping: " << ring.MappingBytes() / 1024 << " KiB, "
+            << ring.SlotCount() << " slots x " << ring.SlotBytes()
+            << " bytes\n";
+
+  pid_t child = fork();
+  if (child == 0) {
+    ConsumerProcess(ring, 1, 0);
+  }
+
+  ring.AttachProducer();
+  auto start = std::chrono::steady_clock::now();
+  uint64_t produced = 0;
+  for (uint64_t id = 1; id <= total_frames; ++id) {
+    if (!ProduceFrame(ring, id, std::chrono::milliseconds(2000))) break;
+    ++produced;
+  }
+  ring.Stop();
+  int exit_code = WaitChild(child);
+  auto elapsed = std::chrono::duration<double, std::milli>(
+      std::chrono::steady_clock::now() - start);
+
+  std::cout << "Produced: " << produced << " frames in " << elapsed.count()
+            << " ms, consumer exit code: " << exit_code << "\n";
+
+  if (produced == total_frames && exit_code == 0) {
+    std::cout << "[PASSED] Cross-process transfer test\n";
+  } else {
+    std::cout << "[FAILED] Cross-process transfer test\n";
+  }
+}
+
+// 测试2：消费进程崩溃后重连
+void TestConsumerCrashRecovery() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 2: Consumer Crash and Reattach\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  const int crash_after = 5;
+  auto ring = ShmFrameRing::CreateAnonymous(4, kFrameBytes);
+  ring.AttachProducer();
+
+  pid_t first = fork();
+  if (first == 0) {
+    ConsumerProcess(ring, 1, crash_after);
+  }
+
+  // 持续生产，直到队列写满且检测到消费进程已退出
+  uint64_t next_id = 1;
+  while (ProduceFrame(ring, next_id, std::chrono::milliseconds(2000))) {
+    ++next_id;
+  }
+  int first_status = WaitChild(first);
+  uint64_t generation_before = ring.Generation();
+  std::cout << "First consumer status: " << first_status
+            << ", producer stalled at frame " << next_id
+            << ", queued: " << ring.Size() << "\n";
+
+  // 新的消费进程重连：未归还的第 crash_after 帧会被重新读到
+  pid_t second = fork();
+  if (second == 0) {
+    ConsumerProcess(ring, static_cast<uint64_t>(crash_after), 0);
+  }
+
+  const uint64_t last_id = next_id + 20;
+  bool produced_all = true;
+  for (; next_id < last_id; ++next_id) {
+    if (!ProduceFrame(ring, next_id, std::chrono::milliseconds(2000))) {
+      produced_all = false;
+      break;
+    }
+  }
+  ring.Stop();
+  int second_status = WaitChild(second);
+
+  std::cout << "Generation: " << generation_before << " -> "
+            << ring.Generation() << ", second consumer status: "
+            << second_status << "\n";
+
+  if (first_status == -SIGKILL && second_status == 0 && produced_all &&
+      ring.Generation() > generation_before) {
+    std::cout << "[PASSED] Consumer crash recovery test\n";
+  } else {
+    std::cout << "[FAILED] Consumer crash recovery test\n";
+  }
+}
+
+// 测试3：持锁进程崩溃后恢复 robust mutex
+void TestLockHolderCrashRecovery() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 3: Robust Mutex Recovery (Holder Dies Inside Lock)\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  auto ring = ShmFrameRing::CreateAnonymous(4, kFrameBytes);
+  ring.AttachProducer();
+
+  // 子进程以消费者身份注册，随后在持锁状态下退出
+  pid_t child = fork();
+  if (child == 0) {
+    ring.AttachConsumer();
+    ring.ExitWhileHoldingLockForTesting(0);
+  }
+  int child_status = WaitChild(child);
+
+  // 下一次加锁收到 EOWNERDEAD：恢复锁并计数；死亡的消费者 pid 被清除
+  uint64_t recoveries = ring.Recoveries();
+  uint64_t generation = ring.Generation();
+
+  // 恢复后环形缓冲区照常工作（本进程同时充当两端）
+  ring.AttachConsumer();
+  bool transfer_ok = true;
+  for (uint64_t id = 1; id <= 6 && transfer_ok; ++id) {
+    transfer_ok = ProduceFrame(ring, id, std::chrono::milliseconds(500));
+    auto frame = ring.AcquireRead(std::chrono::milliseconds(500));
+    transfer_ok = transfer_ok && frame.has_value() &&
+                  frame->Desc().frame_id == id &&
+                  VerifyFrame(frame->Pixels(), id);
+  }
+
+  std::cout << "Child exit status: " << child_status
+            << ", recoveries: " << recoveries
+            << ", generation after recovery: " << generation
+            << ", transfer after recovery: " << (transfer_ok ? "ok" : "broken")
+            << "\n";
+
+  if (child_status == 0 && recoveries == 1 && transfer_ok &&
+      ring.Recoveries() == 1) {
+    std::cout << "[PASSED] Robust mutex recovery test\n";
+  } else {
+    std::cout << "[FAILED] Robust mutex recovery test\n";
+  }
+}
+
+// 测试4：每端同一时间只能持有一个槽位
+void TestSingleOutstandingSlot() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Test 4: One Outstanding Slot Per Side\n";
+  std::cout << std::string(60, '=') << "\n";
+
+  auto ring = ShmFrameRing::CreateAnonymous(4, kFrameBytes);
+  ring.AttachProducer();
+  ring.AttachConsumer();
+
+  auto ThrowsLogicError = [](auto&& acquire) {
+    try {
+      acquire();
+    } catch (const std::logic_error&) {
+      return true;
+    }
+    return false;
+  };
+  const auto kShort = std::chrono::milliseconds(100);
+
+  bool write_rejected = false;
+  {
+    auto slot = ring.AcquireWrite(kShort);
+    write_rejected = slot.has_value() &&
+                     ThrowsLogicError([&] { ring.AcquireWrite(kShort); });
+    // slot 未 Commit 即析构：放弃，不发布
+  }
+  bool abandoned_not_published = ring.Size() == 0;
+
+  ProduceFrame(ring, 1, kShort);
+  ProduceFrame(ring, 2, kShort);
+  bool read_rejected = false;
+  {
+    auto frame = ring.AcquireRead(kShort);
+    read_rejected = frame.has_value() &&
+                    ThrowsLogicError([&] { ring.AcquireRead(kShort); });
+  }
+  // 只归还了一次：head_ 只推进 1，第 2 帧仍在队列中
+  auto next = ring.AcquireRead(kShort);
+  bool cursor_ok = next.has_value() && next->Desc().frame_id == 2;
+
+  std::cout << "Second AcquireWrite rejected: " << write_rejected
+            << ", abandoned slot unpublished: " << abandoned_not_published
+            << ", second AcquireRead rejected: " << read_rejected
+            << ", next frame is #2: " << cursor_ok << "\n";
+
+  if (write_rejected && abandoned_not_published && read_rejected &&
+      cursor_ok) {
+    std::cout << "[PASSED] Single outstanding slot test\n";
+  } else {
+    std::cout << "[FAILED] Single outstanding slot test\n";
+  }
+}
+
+}  // namespace w4
+
+int main() {
+  std::cout << "========================================\n";
+  std::cout << "W4: 跨进程共享内存帧队列\n";
+  std::cout << "========================================\n";
+
+  w4::TestCrossProcessTransfer();
+  w4::TestConsumerCrashRecovery();
+  w4::TestLockHolderCrashRecovery();
+  w4::TestSingleOutstandingSlot();
+
+  std::cout << "\n========================================\n";
+  std::cout << "All tests completed!\n";
+  std::cout << "========================================\n";
+  return 0;
+}
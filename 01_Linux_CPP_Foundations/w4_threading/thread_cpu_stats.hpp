@@ -0,0 +1,146 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：线程级 CPU 时间统计 - 区分"在算"和"在等"
+//
+// 知识点：
+// 1. CLOCK_THREAD_CPUTIME_ID：只统计本线程真正占用 CPU 的时间
+// 2. /proc/self/task/<tid>/status 中的上下文切换计数
+//    - voluntary_ctxt_switches：主动让出（等锁、等条件变量、sleep、I/O）
+//    - nonvoluntary_ctxt_switches：被调度器抢占（时间片用完、CPU 不够分）
+// 3. CPU 利用率 = CPU 时间 / 墙钟时间，接近 1 为计算受限，接近 0 为等待受限
+
+#ifndef W4_THREADING_THREAD_CPU_STATS_HPP_
+#define W4_THREADING_THREAD_CPU_STATS_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace w4 {
+
+// =============================================================================
+// 为什么墙钟延迟不够？
+// =============================================================================
+// ImageConsumer 测到的"延迟"= 排队等待 + 抢锁 + 真正计算 + 被抢占的时间。
+// 同样 20ms 的处理时间：
+//   - CPU 时间 ≈ 20ms，主动切换少  → 计算受限，优化算法或加核
+//   - CPU 时间 ≈ 0.1ms，主动切换多 → 在等（sleep / 锁 / I/O），加核没用
+//   - CPU 时间 < 墙钟，被动切换多  → CPU 不够分，线程数超过核数
+// =============================================================================
+
+// 某一时刻某个线程的累计计数
+struct ThreadCpuSample {
+  std::chrono::steady_clock::time_point wall{};
+  uint64_t cpu_ns = 0;
+  uint64_t voluntary_switches = 0;
+  uint64_t involuntary_switches = 0;
+};
+
+inline pid_t CurrentTid() { return static_cast<pid_t>(syscall(SYS_gettid)); }
+
+// 读取任意线程（tid）的上下文切换计数；读取失败时保持为 0
+inline void ReadTaskSwitches(pid_t tid, uint64_t* voluntary,
+                             uint64_t* involuntary) {
+  std::ifstream status("/proc/self/task/" + std::to_string(tid) + "/status");
+  std::string key;
+  while (status >> key) {
+    if (key == "voluntary_ctxt_switches:") {
+      status >> *voluntary;
+    } else if (key == "nonvoluntary_ctxt_switches:") {
+      status >> *involuntary;
+    }
+  }
+}
+
+// 采样调用线程自身（CLOCK_THREAD_CPUTIME_ID 只能读当前线程）
+inline ThreadCpuSample SampleCurrentThread() {
+  ThreadCpuSample sample;
+  sample.wall = std::chrono::steady_clock::now();
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  sample.cpu_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL +
+                  static_cast<uint64_t>(ts.tv_nsec);
+  ReadTaskSwitches(CurrentTid(), &sample.voluntary_switches,
+                   &sample.involuntary_switches);
+  return sample;
+}
+
+// 一个线程在一段区间内的统计结果
+struct ThreadCpuReport {
+  std::string stage;  // 例如 "producer"、"consumer-1"
+  uint64_t wall_ns = 0;
+  uint64_t cpu_ns = 0;
+  uint64_t voluntary_switches = 0;
+  uint64_t involuntary_switches = 0;
+  uint64_t frames = 0;
+
+  double Utilization() const {
+    return wall_ns == 0 ? 0.0
+                        : static_cast<double>(cpu_ns) / static_cast<double>(wall_ns);
+  }
+  double CpuNsPerFrame() const {
+    return frames == 0 ? 0.0
+                       : static_cast<double>(cpu_ns) / static_cast<double>(frames);
+  }
+};
+
+// =============================================================================
+// ThreadCpuMeter - 在线程函数开头 Begin()、结尾 End()
+// =============================================================================
+// 两次采样都必须在被测线程内调用；End() 之后由其他线程读取 Report()
+// （线程 join 提供了必要的同步）。
+// =============================================================================
+class ThreadCpuMeter {
+ public:
+  void Begin() { begin_ = SampleCurrentThread(); }
+
+  void End(const std::string& stage, uint64_t frames) {
+    ThreadCpuSample end = SampleCurrentThread();
+    report_.stage = stage;
+    report_.wall_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end.wall - begin_.wall)
+            .count());
+    report_.cpu_ns = end.cpu_ns - begin_.cpu_ns;
+    report_.voluntary_switches = end.voluntary_switches - begin_.voluntary_switches;
+    report_.involuntary_switches =
+        end.involuntary_switches - begin_.involuntary_switches;
+    report_.frames = frames;
+  }
+
+  const ThreadCpuReport& Report() const { return report_; }
+
+ private:
+  ThreadCpuSample begin_;
+  ThreadCpuReport report_;
+};
+
+// 每个阶段一行：利用率、主动/被动切换、每帧 CPU 时间
+inline void PrintCpuReport(std::ostream& os,
+                           const std::vector<ThreadCpuReport>& reports) {
+  os << "  " << std::left << std::setw(14) << "stage" << std::right
+     << std::setw(10) << "wall(ms)" << std::setw(10) << "cpu(ms)"
+     << std::setw(8) << "util%" << std::setw(9) << "vol_cs" << std::setw(9)
+     << "invol_cs" << std::setw(8) << "frames" << std::setw(14)
+     << "cpu_us/frame" << "\n";
+  for (const ThreadCpuReport& r : reports) {
+    os << "  " << std::left << std::setw(14) << r.stage << std::right
+       << std::fixed << std::setprecision(1) << std::setw(10)
+       << static_cast<double>(r.wall_ns) / 1e6 << std::setw(10)
+       << static_cast<double>(r.cpu_ns) / 1e6 << std::setw(8)
+       << r.Utilization() * 100.0 << std::setw(9) << r.voluntary_switches
+       << std::setw(9) << r.involuntary_switches << std::setw(8) << r.frames
+       << std::setw(14) << r.CpuNsPerFrame() / 1e3 << "\n";
+    os.unsetf(std::ios::fixed);
+  }
+}
+
+}  // namespace w4
+
+#endif  // W4_THREADING_THREAD_CPU_STATS_HPP_
@@ -0,0 +1,397 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：线程安全的环形缓冲区（mutex + condition_variable）
+//
+// 知识点：
+// 1. std::mutex 与 std::unique_lock
+// 2. std::condition_variable 的谓词等待与超时
+// 3. 基于停止标志的优雅退出
+// 4. 可选的 eventfd 就绪通知，接入 epoll 事件循环
+// 5. Close() 通道语义与 range-for 迭代：for (auto& item : buffer) { ... }
+// 6. 可挂接飞行记录仪，Push / Pop 时记录入队、出队事件
+
+#ifndef W4_THREADING_THREAD_SAFE_RING_BUFFER_HPP_
+#define W4_THREADING_THREAD_SAFE_RING_BUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "flight_recorder.hpp"
+
+namespace w4 {
+
+// =============================================================================
+// ThreadSafeRingBuffer 类 - 线程安全的环形缓冲区
+// =============================================================================
+// 核心设计思想：
+// 1. 使用 std::mutex 保护共享数据（buffer_, head_, tail_, count_）
+// 2. 使用 std::condition_variable 实现阻塞等待
+//    - not_full_cv_: 当缓冲区满时，生产者等待
+//    - not_empty_cv_: 当缓冲区空时，消费者等待
+// 3. 使用 std::atomic<bool> 实现优雅停止
+// 4. EnableReadinessFd() 之后同时通过 eventfd 通知"非空"，供 epoll 线程使用
+// 5. 锁类型可替换：Mutex = ProfiledMutex 时统计该缓冲区锁的争用情况
+//    （非 std::mutex 时条件变量自动换成 std::condition_variable_any）
+// =============================================================================
+template <typename T, size_t Capacity, typename Mutex = std::mutex>
+class ThreadSafeRingBuffer {
+ public:
+  ThreadSafeRingBuffer()
+      : head_(0), tail_(0), count_(0), popped_total_(0), stopped_(false) {
+    static_assert(Capacity > 0, "Capacity must be greater than 0");
+  }
+
+  // 为锁命名（锁类型可由名字构造时可用，例如 ProfiledMutex）
+  template <typename M = Mutex,
+            typename = std::enable_if_t<std::is_constructible_v<M, const char*>>>
+  explicit ThreadSafeRingBuffer(const char* lock_name)
+      : head_(0), tail_(0), count_(0), popped_total_(0), stopped_(false),
+        mutex_(lock_name) {
+    static_assert(Capacity > 0, "Capacity must be greater than 0");
+  }
+
+  ~ThreadSafeRingBuffer() {
+    if (event_fd_ >= 0) close(event_fd_);
+  }
+
+  // 禁用拷贝和移动 - 环形缓冲区通常作为共享资源存在
+  ThreadSafeRingBuffer(const ThreadSafeRingBuffer&) = delete;
+  ThreadSafeRingBuffer& operator=(const ThreadSafeRingBuffer&) = delete;
+  ThreadSafeRingBuffer(ThreadSafeRingBuffer&&) = delete;
+  ThreadSafeRingBuffer& operator=(ThreadSafeRingBuffer&&) = delete;
+
+  // =========================================================================
+  // Push - 阻塞式入队操作
+  // =========================================================================
+  // 知识点：为什么使用 std::unique_lock 而不是 std::lock_guard？
+  //
+  // std::lock_guard:
+  //   - 简单的 RAII 锁包装器
+  //   - 构造时加锁，析构时解锁
+  //   - 不能手动解锁/重新加锁
+  //
+  // std::unique_lock:
+  //   - 更灵活的锁包装器
+  //   - 支持手动 lock()/unlock()
+  //   - 支持与 condition_variable 配合使用
+  //   - condition_variable::wait() 会自动释放锁并等待
+  //
+  // 在 wait() 期间锁被释放，允许其他线程操作缓冲区
+  // 当被唤醒后，锁会自动重新获取
+  // =========================================================================
+  bool Push(T item, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<Mutex> lock(mutex_);
+
+    // 等待条件：缓冲区未满 或 已停止
+    auto predicate = [this]() { return count_ < Capacity || stopped_; };
+
+    if (timeout == std::chrono::milliseconds::max()) {
+      not_full_cv_.wait(lock, predicate);
+    } else {
+      if (!not_full_cv_.wait_for(lock, timeout, predicate)) {
+        return false;  // 超时
+      }
+    }
+
+    if (stopped_) {
+      return false;  // 已停止，不再接受新数据
+    }
+
+    // 入队操作
+    const uint64_t trace_id = FlightFrameId(item);
+    buffer_[tail_] = std::move(item);
+    tail_ = (tail_ + 1) % Capacity;
+    if (++count_ == 1) SignalReadyLocked();  // 空 → 非空
+    // 在锁内记录：保证同一帧的"入队"时间戳一定早于"出队"
+    Trace(FrameEvent::kEnqueued, trace_id, count_);
+
+    // 通知等待的消费者
+    lock.unlock();  // 先解锁再通知，提高效率
+    not_empty_cv_.notify_one();
+
+    return true;
+  }
+
+  // =========================================================================
+  // Pop - 阻塞式出队操作
+  // =========================================================================
+  // 返回 std::optional 的设计考量：
+  // 1. 当缓冲区被停止时，需要一种方式告知消费者"没有更多数据"
+  // 2. std::optional 完美表达"可能有值，也可能没有"的语义
+  // 3. 避免使用异常或错误码，代码更清晰
+  // =========================================================================
+  std::optional<T> Pop(std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    std::unique_lock<Mutex> lock(mutex_);
+
+    // 等待条件：缓冲区非空 或 已停止
+    auto predicate = [this]() { return count_ > 0 || stopped_; };
+
+    if (timeout == std::chrono::milliseconds::max()) {
+      not_empty_cv_.wait(lock, predicate);
+    } else {
+      if (!not_empty_cv_.wait_for(lock, timeout, predicate)) {
+        return std::nullopt;  // 超时
+      }
+    }
+
+    // 即使已停止，如果还有数据也要消费完
+    if (count_ == 0) {
+      return std::nullopt;  // 已停止且无数据
+    }
+
+    T item = PopLocked();
+
+    // 通知等待的生产者
+    lock.unlock();
+    not_full_cv_.notify_one();
+
+    return item;
+  }
+
+  // =========================================================================
+  // TryPop - 非阻塞出队（事件循环线程使用，不能在条件变量上阻塞）
+  // =========================================================================
+  std::optional<T> TryPop() {
+    std::unique_lock<Mutex> lock(mutex_);
+    if (count_ == 0) return std::nullopt;
+    T item = PopLocked();
+    lock.unlock();
+    not_full_cv_.notify_one();
+    return item;
+  }
+
+  // =========================================================================
+  // EnableReadinessFd - 打开 eventfd 就绪通知，返回可注册到 epoll 的 fd
+  // =========================================================================
+  // 语义：eventfd 计数器非零 ⇔ 队列非空（或已 Stop）
+  //   - 空 → 非空时写入一次（之后的 Push 不再写，避免无谓的系统调用）
+  //   - 非空 → 空时在锁内读走计数，fd 重新变为不可读
+  //   - Close() 时写入一次且不再清除，事件循环取完剩余数据后用 IsClosed() 判断结束
+  //
+  // 事件循环用法（EPOLLIN | EPOLLET，边沿触发）：
+  //   epoll_ctl(ep, EPOLL_CTL_ADD, queue.EnableReadinessFd(), &ev);
+  //   // 被唤醒后必须一直 TryPop() 直到返回 nullopt，
+  //   // 否则不会再出现下一次"空 → 非空"的边沿
+  //   while (auto frame = queue.TryPop()) Handle(*frame);
+  //
+  // 不需要自己 read() 这个 fd；fd 由队列持有，析构时关闭。
+  // 重复调用返回同一个 fd。
+  // =========================================================================
+  int EnableReadinessFd() {
+    std::lock_guard<Mutex> lock(mutex_);
+    if (event_fd_ < 0) {
+      event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (event_fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "eventfd");
+      }
+      if (count_ > 0 || stopped_) SignalReadyLocked();
+    }
+    return event_fd_;
+  }
+
+  // 未启用时返回 -1
+  int ReadinessFd() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return event_fd_;
+  }
+
+  // 累计写入 eventfd 的次数（只在空 → 非空和 Stop 时写入）
+  uint64_t GetReadinessSignalCount() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return readiness_signals_;
+  }
+
+  // =========================================================================
+  // 飞行记录仪（在启动生产者/消费者之前挂接；nullptr 表示不记录）
+  // =========================================================================
+  // 未挂接时 Push/Pop 只多一次 relaxed 读（事件在锁内记录，保证同一帧入队早于出队）；
+  // 生产者、消费者也通过
+  // GetFlightRecorder() 拿到同一个记录仪，记录采集与处理事件。
+  // =========================================================================
+  void AttachFlightRecorder(FlightRecorder* recorder) {
+    recorder_.store(recorder, std::memory_order_release);
+  }
+  FlightRecorder* GetFlightRecorder() const {
+    return recorder_.load(std::memory_order_acquire);
+  }
+
+  // =========================================================================
+  // Close - 关闭通道（Go channel 语义）
+  // =========================================================================
+  // 设计考量：
+  // 1. 关闭后 Push 立即返回 false（阻塞中的生产者也会被唤醒并失败）
+  // 2. 消费者照常取完剩余数据，之后无超时的 Pop() 返回 nullopt —— 明确的"流结束"
+  // 3. 唤醒所有等待的线程，消费者不需要靠超时轮询来发现结束
+  //
+  // 因此关闭的延迟只是一次 notify_all 的唤醒时间（微秒级），
+  // 而不是消费者 Pop 超时的长度。
+  // =========================================================================
+  void Close() {
+    {
+      std::lock_guard<Mutex> lock(mutex_);
+      stopped_ = true;
+      SignalReadyLocked();  // 让事件循环醒来看到关闭
+    }
+    // 唤醒所有等待的线程
+    not_full_cv_.notify_all();
+    not_empty_cv_.notify_all();
+  }
+
+  // Stop() 是 Close() 的旧名字，语义相同
+  void Stop() { Close(); }
+
+  // =========================================================================
+  // 迭代器 - 把"取到流结束为止"写成 range-for
+  // =========================================================================
+  //   for (auto& frame : buffer) Process(frame);   // Close() 且取空后退出循环
+  //
+  // 单遍输入迭代器：++ 即阻塞 Pop()，元素由迭代器持有到下一次 ++。
+  // 多个消费者线程可以各自对同一个缓冲区做 range-for，每个元素只被一个线程取到。
+  // =========================================================================
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    Iterator() = default;  // 流结束哨兵
+    explicit Iterator(ThreadSafeRingBuffer* buffer) : buffer_(buffer) { Advance(); }
+
+    T& operator*() { return *current_; }
+    T* operator->() { return &*current_; }
+
+    Iterator& operator++() {
+      Advance();
+      return *this;
+    }
+
+    // 输入迭代器只需比较"是否已结束"
+    bool operator==(const Iterator& other) const {
+      return AtEnd() == other.AtEnd();
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    void Advance() { current_ = buffer_->Pop(); }
+    bool AtEnd() const { return !current_.has_value(); }
+
+    ThreadSafeRingBuffer* buffer_ = nullptr;
+    std::optional<T> current_;
+  };
+
+  Iterator begin() { return Iterator(this); }
+  Iterator end() { return Iterator(); }
+
+  // 重置缓冲区（用于测试）
+  void Reset() {
+    std::lock_guard<Mutex> lock(mutex_);
+    head_ = 0;
+    tail_ = 0;
+    count_ = 0;
+    popped_total_ = 0;
+    stopped_ = false;
+    readiness_signals_ = 0;
+    ClearReadyLocked();
+  }
+
+  // 查询方法（用于调试和统计）
+  size_t Size() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return count_;
+  }
+
+  bool Empty() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return count_ == 0;
+  }
+
+  bool Full() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return count_ == Capacity;
+  }
+
+  // 累计出队数（准入控制据此估计消费端服务速率）
+  uint64_t GetPoppedCount() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return popped_total_;
+  }
+
+  bool IsClosed() const { return IsStopped(); }
+
+  bool IsStopped() const {
+    std::lock_guard<Mutex> lock(mutex_);
+    return stopped_;
+  }
+
+  static constexpr size_t GetCapacity() { return Capacity; }
+
+ private:
+  // 未挂接记录仪时只有一次 relaxed 读；记录本身无锁，可在持锁期间调用
+  void Trace(FrameEvent event, uint64_t frame_id, size_t depth) {
+    FlightRecorder* recorder = recorder_.load(std::memory_order_relaxed);
+    if (recorder != nullptr) recorder->Record(event, frame_id, depth);
+  }
+
+  using CondVar = std::conditional_t<std::is_same_v<Mutex, std::mutex>,
+                                     std::condition_variable,
+                                     std::condition_variable_any>;
+
+  // 以下 *Locked 函数要求调用方已持有 mutex_
+  T PopLocked() {
+    T item = std::move(buffer_[head_]);
+    head_ = (head_ + 1) % Capacity;
+    ++popped_total_;
+    // 非空 → 空；停止后保持可读，事件循环总能看到结束
+    if (--count_ == 0 && !stopped_) ClearReadyLocked();
+    Trace(FrameEvent::kDequeued, FlightFrameId(item), count_);
+    return item;
+  }
+
+  // eventfd 是非阻塞的，写满（计数接近 2^64）或读空都不会阻塞，失败可以忽略
+  void SignalReadyLocked() {
+    if (event_fd_ < 0) return;
+    uint64_t one = 1;
+    ssize_t n = write(event_fd_, &one, sizeof(one));
+    (void)n;
+    ++readiness_signals_;
+  }
+
+  void ClearReadyLocked() {
+    if (event_fd_ < 0) return;
+    uint64_t value = 0;
+    ssize_t n = read(event_fd_, &value, sizeof(value));
+    (void)n;
+  }
+
+  std::array<T, Capacity> buffer_;  // 环形缓冲区存储
+  size_t head_;                     // 出队位置
+  size_t tail_;                     // 入队位置
+  size_t count_;                    // 当前元素数量
+  uint64_t popped_total_;           // 累计出队数
+  bool stopped_;                    // 关闭标志
+  int event_fd_ = -1;               // 就绪通知 eventfd（-1 表示未启用）
+  uint64_t readiness_signals_ = 0;  // 写入 eventfd 的次数
+  std::atomic<FlightRecorder*> recorder_{nullptr};  // 飞行记录仪（可选）
+
+  mutable Mutex mutex_;                     // 互斥锁 (mutable 允许在 const 方法中使用)
+  CondVar not_full_cv_;                     // 缓冲区未满条件变量
+  CondVar not_empty_cv_;                    // 缓冲区非空条件变量
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_THREAD_SAFE_RING_BUFFER_HPP_
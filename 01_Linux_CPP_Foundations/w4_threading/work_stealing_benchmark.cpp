@@ -0,0 +1,255 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：工作窃取 vs 单锁共享队列 - 处理时间倾斜时的吞吐与 p99 延迟
+//
+// 知识点：
+// 1. 共享队列：负载天然均衡，但每帧都抢同一把锁
+// 2. 纯轮转本地队列：没有热点锁，但慢帧后面的帧只能干等
+// 3. 工作窃取：平时只碰本地锁，失衡时空闲消费者从队尾偷帧
+// 4. 延迟 = 入队 → 处理完成，按固定帧率输入，统计 p50 / p99
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_safe_ring_buffer.hpp"
+#include "work_stealing_queue.hpp"
+
+namespace w4 {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kNumConsumers = 4;
+constexpr int kTotalFrames = 2000;
+constexpr double kInputFps = 1000.0;  // 0 表示不限速（饱和输入）
+constexpr size_t kTotalCapacity = 64;  // 共享队列容量 = 本地队列容量之和
+
+// 倾斜的处理时间：90% 的帧 1ms，10% 的帧 12ms（例如目标突然变多的画面）
+constexpr auto kFastService = std::chrono::microseconds(1000);
+constexpr auto kSlowService = std::chrono::microseconds(12000);
+constexpr int kSlowPercent = 10;
+
+struct Job {
+  uint64_t id = 0;
+  Clock::time_point enqueued{};
+  std::chrono::microseconds service{0};
+};
+
+struct BenchResult {
+  double fps = 0.0;
+  double p50_ms = 0.0;
+  double p99_ms = 0.0;
+  double max_ms = 0.0;
+  uint64_t processed = 0;
+  uint64_t steals = 0;
+};
+
+// 所有模式使用同一串处理时间，保证可比
+std::vector<std::chrono::microseconds> MakeServiceTimes() {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::vector<std::chrono::microseconds> times(kTotalFrames);
+  for (auto& t : times) t = percent(rng) < kSlowPercent ? kSlowService : kFastService;
+  return times;
+}
+
+// 消费者记录每帧延迟；结束后合并计算分位数
+class LatencyLog {
+ public:
+  void Add(const std::vector<double>& samples) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_.insert(samples_.end(), samples.begin(), samples.end());
+  }
+
+  void Fill(BenchResult* r) {
+    std::sort(samples_.begin(), samples_.end());
+    r->processed = samples_.size();
+    if (samples_.empty()) return;
+    auto at = [this](double q) {
+      return samples_[static_cast<size_t>(q * static_cast<double>(samples_.size() - 1))];
+    };
+    r->p50_ms = at(0.50);
+    r->p99_ms = at(0.99);
+    r->max_ms = samples_.back();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<double> samples_;
+};
+
+// 处理一帧：sleep 模拟（与 ImageConsumer 一致，单核机器上也能体现并行度），返回延迟
+double Process(const Job& job) {
+  std::this_thread::sleep_for(job.service);
+  return std::chrono::duration<double, std::milli>(Clock::now() - job.enqueued)
+      .count();
+}
+
+// 按固定帧率产生 kTotalFrames 帧（fps == 0 时不限速）；push 返回 false 视为结束
+template <typename PushFn>
+void ProduceAtFixedRate(const std::vector<std::chrono::microseconds>& services,
+                        double fps, PushFn push) {
+  const auto interval =
+      fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(
+                      std::chrono::duration<double>(1.0 / fps))
+                : Clock::duration::zero();
+  auto next = Clock::now();
+  for (int i = 0; i < kTotalFrames; ++i) {
+    if (fps > 0.0) {
+      std::this_thread::sleep_until(next);
+      next += interval;
+    }
+    Job job;
+    job.id = static_cast<uint64_t>(i);
+    job.enqueued = Clock::now();
+    job.service = services[static_cast<size_t>(i)];
+    if (!push(std::move(job))) return;
+  }
+}
+
+BenchResult BenchSharedQueue(const std::vector<std::chrono::microseconds>& services,
+                             double fps) {
+  ThreadSafeRingBuffer<Job, kTotalCapacity> buffer;
+  LatencyLog log;
+
+  auto start = Clock::now();
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    consumers.emplace_back([&]() {
+      std::vector<double> local;
+      for (Job& job : buffer) local.push_back(Process(job));
+      log.Add(local);
+    });
+  }
+  ProduceAtFixedRate(services, fps,
+                     [&](Job job) { return buffer.Push(std::move(job)); });
+  buffer.Close();
+  for (auto& t : consumers) t.join();
+
+  BenchResult r;
+  log.Fill(&r);
+  r.fps = static_cast<double>(r.processed) /
+          std::chrono::duration<double>(Clock::now() - start).count();
+  return r;
+}
+
+BenchResult BenchLocalQueues(const std::vector<std::chrono::microseconds>& services,
+                             double fps, bool enable_stealing) {
+  WorkStealingQueue<Job> queue(kNumConsumers, kTotalCapacity / kNumConsumers,
+                               enable_stealing);
+  LatencyLog log;
+
+  auto start = Clock::now();
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < kNumConsumers; ++c) {
+    consumers.emplace_back([&, c]() {
+      std::vector<double> local;
+      while (auto job = queue.Pop(static_cast<size_t>(c))) {
+        local.push_back(Process(*job));
+      }
+      log.Add(local);
+    });
+  }
+  ProduceAtFixedRate(services, fps,
+                     [&](Job job) { return queue.Push(std::move(job)); });
+  queue.Close();
+  for (auto& t : consumers) t.join();
+
+  BenchResult r;
+  log.Fill(&r);
+  r.fps = static_cast<double>(r.processed) /
+          std::chrono::duration<double>(Clock::now() - start).count();
+  r.steals = queue.GetTotalSteals();
+  return r;
+}
+
+void PrintRow(const std::string& name, const BenchResult& r) {
+  std::cout << std::left << std::setw(26) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << r.fps << std::setw(10)
+            << r.p50_ms << std::setw(10) << r.p99_ms << std::setw(10) << r.max_ms
+            << std::setw(10) << r.processed << std::setw(9) << r.steals << "\n";
+  std::cout.unsetf(std::ios::fixed);
+}
+
+// 一种输入速率下的三种分发方式；require_rebalance 时要求窃取缩短 p99
+bool RunScenario(const std::string& title, double fps,
+                 const std::vector<std::chrono::microseconds>& services,
+                 bool require_rebalance) {
+  std::cout << "\n" << title << "\n";
+  std::cout << std::left << std::setw(26) << "distribution" << std::right
+            << std::setw(10) << "fps" << std::setw(10) << "p50(ms)"
+            << std::setw(10) << "p99(ms)" << std::setw(10) << "max(ms)"
+            << std::setw(10) << "frames" << std::setw(9) << "steals" << "\n";
+
+  BenchResult shared = BenchSharedQueue(services, fps);
+  BenchResult round_robin = BenchLocalQueues(services, fps, false);
+  BenchResult stealing = BenchLocalQueues(services, fps, true);
+
+  PrintRow("shared ThreadSafeRingBuffer", shared);
+  PrintRow("round-robin, no stealing", round_robin);
+  PrintRow("work stealing", stealing);
+
+  const uint64_t expected = kTotalFrames;
+  bool complete = shared.processed == expected &&
+                  round_robin.processed == expected &&
+                  stealing.processed == expected;
+  // 窃取必须真的发生，并且消除纯轮转的排队尾巴；
+  // 饱和输入时每条本地队列都是满的，几乎无从可偷，只比较吞吐
+  bool balanced = !require_rebalance ||
+                  (stealing.steals > 0 && stealing.p99_ms < round_robin.p99_ms);
+  std::cout << std::fixed << std::setprecision(1) << "  stealing vs round-robin p99: "
+            << round_robin.p99_ms << "ms -> " << stealing.p99_ms
+            << "ms, vs shared queue: " << shared.p99_ms << "ms\n";
+  std::cout.unsetf(std::ios::fixed);
+  return complete && balanced;
+}
+
+}  // namespace
+
+void RunWorkStealingBenchmark() {
+  std::cout << "\n" << std::string(60, '=') << "\n";
+  std::cout << "Benchmark: Skewed Processing Times (" << kNumConsumers
+            << " consumers, " << kTotalFrames << " frames)\n";
+  std::cout << std::string(60, '=') << "\n";
+  std::cout << "Service time: " << 100 - kSlowPercent << "% "
+            << kFastService.count() / 1000.0 << "ms, " << kSlowPercent << "% "
+            << kSlowService.count() / 1000.0 << "ms; total capacity "
+            << kTotalCapacity << " frames\n";
+
+  const auto services = MakeServiceTimes();
+  bool ok = RunScenario("Paced input @ " + std::to_string(static_cast<int>(kInputFps)) +
+                            " FPS (rho ~ 0.5)",
+                        kInputFps, services, true);
+  ok = RunScenario("Saturated input (producer never sleeps)", 0.0, services, false) &&
+       ok;
+
+  if (ok) {
+    std::cout << "[PASSED] Every frame processed; stealing removed the round-robin tail\n";
+  } else {
+    std::cout << "[FAILED] Lost frames or stealing did not rebalance load\n";
+  }
+}
+
+}  // namespace w4
+
+int main() {
+  std::cout << "========================================\n";
+  std::cout << "W4: 工作窃取 vs 共享队列\n";
+  std::cout << "========================================\n";
+
+  w4::RunWorkStealingBenchmark();
+
+  std::cout << "\n========================================\n";
+  std::cout << "All benchmarks completed!\n";
+  std::cout << "========================================\n";
+  return 0;
+}
@@ -0,0 +1,232 @@
+// Copyright 2026 Edge-AI-Genesis
+// 文件功能：工作窃取分发 - 每个消费者一条本地队列，空闲时从别人的队尾偷帧
+//
+// 知识点：
+// 1. 生产者轮转（round-robin）分发到各消费者的本地队列，没有全局共享的锁
+// 2. 本地队列是双端的：主人从队头取（FIFO），窃取者从队尾偷，两端争用最小
+// 3. 处理时间倾斜时（偶尔一帧特别慢），慢消费者队列里积压的帧被空闲消费者偷走
+// 4. 复用 sharded_queue.hpp 的 EventCount：无人等待时通知不加锁
+
+#ifndef W4_THREADING_WORK_STEALING_QUEUE_HPP_
+#define W4_THREADING_WORK_STEALING_QUEUE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "sharded_queue.hpp"
+
+namespace w4 {
+
+// =============================================================================
+// 为什么要工作窃取？
+// =============================================================================
+// 单个 ThreadSafeRingBuffer：所有消费者每取一帧都抢同一把锁。
+// 只按轮转分给各自的本地队列：没有热点锁了，但负载不再均衡——
+//   消费者 A 碰上一帧 50ms 的难图，分给 A 的后续帧全部排在它后面，
+//   而 B、C、D 早已空闲。
+// 工作窃取：本地队列为空时去别人的队尾偷一帧。平时每个消费者只碰自己的锁，
+// 只有失衡时才跨线程访问。
+//
+// 本地队列用"一把小锁 + std::deque"实现（而不是 Chase-Lev 无锁双端队列）：
+// 每把锁只被主人和偶尔的窃取者争用，帧级别的吞吐下足够，也便于 Close() 语义。
+// =============================================================================
+template <typename T>
+class WorkStealingQueue {
+ public:
+  // num_workers 条本地队列，每条最多 local_capacity 帧；
+  // enable_stealing = false 时退化为纯轮转分发（用于对比）
+  WorkStealingQueue(size_t num_workers, size_t local_capacity,
+                    bool enable_stealing = true)
+      : local_capacity_(local_capacity), enable_stealing_(enable_stealing) {
+    if (num_workers == 0 || local_capacity == 0) {
+      throw std::invalid_argument("WorkStealingQueue needs workers and capacity");
+    }
+    workers_.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+      workers_.push_back(std::make_unique<Local>());
+    }
+  }
+
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+  // =========================================================================
+  // Push - 轮转到下一个消费者；它满了就顺延到下一个，全满则阻塞
+  // =========================================================================
+  // 单生产者调用（轮转游标不是原子的）；Close() 后返回 false
+  bool Push(T item, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) {
+    auto deadline = Deadline(timeout);
+    while (true) {
+      if (closed_.load(std::memory_order_acquire)) return false;
+      if (TryPushAny(item)) return true;
+
+      uint64_t key = not_full_.PrepareWait();
+      if (closed_.load(std::memory_order_acquire)) {
+        not_full_.CancelWait();
+        return false;
+      }
+      if (TryPushAny(item)) {
+        not_full_.CancelWait();
+        return true;
+      }
+      auto slice = RemainingSlice(deadline);
+      if (slice.count() <= 0) {
+        not_full_.CancelWait();
+        return false;
+      }
+      not_full_.Wait(key, slice);
+    }
+  }
+
+  // =========================================================================
+  // Pop - 消费者 worker 取帧：先本地队头，再从其他队列的队尾偷
+  // =========================================================================
+  // Close() 且所有队列取空后返回 nullopt
+  std::optional<T> Pop(size_t worker) {
+    while (true) {
+      if (auto item = TryPopOrSteal(worker)) return item;
+
+      uint64_t key = not_empty_.PrepareWait();
+      if (auto item = TryPopOrSteal(worker)) {
+        not_empty_.CancelWait();
+        return item;
+      }
+      if (closed_.load(std::memory_order_acquire) && AllEmpty()) {
+        not_empty_.CancelWait();
+        return std::nullopt;
+      }
+      not_empty_.Wait(key, kWaitSlice);
+    }
+  }
+
+  // 关闭后生产者 Push 失败，消费者取完剩余帧后 Pop 返回 nullopt
+  void Close() {
+    closed_.store(true, std::memory_order_release);
+    not_empty_.Notify();
+    not_full_.Notify();
+  }
+
+  size_t NumWorkers() const { return workers_.size(); }
+
+  // worker 从别人那里偷到的帧数
+  uint64_t GetStealCount(size_t worker) const {
+    return workers_[worker]->steals.load(std::memory_order_relaxed);
+  }
+
+  uint64_t GetTotalSteals() const {
+    uint64_t total = 0;
+    for (const auto& w : workers_) total += w->steals.load(std::memory_order_relaxed);
+    return total;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::chrono::milliseconds kWaitSlice{10};
+
+  // 每个消费者一份，单独占缓存行，避免相邻队列的锁互相伪共享
+  struct alignas(kCacheLineSize) Local {
+    std::mutex mutex;
+    std::deque<T> items;
+    std::atomic<uint64_t> steals{0};
+  };
+
+  static Clock::time_point Deadline(std::chrono::milliseconds timeout) {
+    if (timeout == std::chrono::milliseconds::max()) return Clock::time_point::max();
+    return Clock::now() + timeout;
+  }
+
+  static std::chrono::milliseconds RemainingSlice(Clock::time_point deadline) {
+    if (deadline == Clock::time_point::max()) return kWaitSlice;
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - Clock::now());
+    return left < kWaitSlice ? left : kWaitSlice;
+  }
+
+  bool TryPushAny(T& item) {
+    const size_t n = workers_.size();
+    for (size_t k = 0; k < n; ++k) {
+      size_t index = (next_worker_ + k) % n;
+      Local& local = *workers_[index];
+      {
+        std::lock_guard<std::mutex> lock(local.mutex);
+        if (local.items.size() >= local_capacity_) continue;
+        local.items.push_back(std::move(item));
+      }
+      next_worker_ = index + 1;
+      // 开启窃取时任何 worker 都能取走这一帧，唤醒一个即可；
+      // 关闭窃取时只有队列主人能取，而等待者里分不出是谁，只能全部唤醒
+      if (enable_stealing_) {
+        not_empty_.NotifyOne();
+      } else {
+        not_empty_.Notify();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  std::optional<T> TryPopOrSteal(size_t worker) {
+    if (auto item = TryPopFront(*workers_[worker])) return item;
+    if (!enable_stealing_) return std::nullopt;
+
+    const size_t n = workers_.size();
+    for (size_t k = 1; k < n; ++k) {
+      Local& victim = *workers_[(worker + k) % n];
+      if (auto item = TryPopBack(victim)) {
+        workers_[worker]->steals.fetch_add(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::optional<T> TryPopFront(Local& local) {
+    std::unique_lock<std::mutex> lock(local.mutex);
+    if (local.items.empty()) return std::nullopt;
+    T item = std::move(local.items.front());
+    local.items.pop_front();
+    lock.unlock();
+    not_full_.NotifyOne();  // 只有一个生产者
+    return item;
+  }
+
+  // 窃取者从队尾取：与主人取队头的位置相隔最远
+  std::optional<T> TryPopBack(Local& local) {
+    std::unique_lock<std::mutex> lock(local.mutex);
+    if (local.items.empty()) return std::nullopt;
+    T item = std::move(local.items.back());
+    local.items.pop_back();
+    lock.unlock();
+    not_full_.NotifyOne();
+    return item;
+  }
+
+  bool AllEmpty() {
+    for (auto& w : workers_) {
+      std::lock_guard<std::mutex> lock(w->mutex);
+      if (!w->items.empty()) return false;
+    }
+    return true;
+  }
+
+  const size_t local_capacity_;
+  const bool enable_stealing_;
+  std::vector<std::unique_ptr<Local>> workers_;
+  size_t next_worker_ = 0;  // 轮转游标，只由生产者线程访问
+  std::atomic<bool> closed_{false};
+  EventCount not_empty_;  // 消费者等待
+  EventCount not_full_;   // 生产者等待（所有本地队列都满）
+};
+
+}  // namespace w4
+
+#endif  // W4_THREADING_WORK_STEALING_QUEUE_HPP_